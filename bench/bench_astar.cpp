@@ -0,0 +1,114 @@
+/*
+ * microbenchmark of space-time A*
+ *
+ * Random space-time cells are blocked to emulate reservations.
+ * Counters: nodes expanded / generated per second.
+ * BM_SpaceTimeAstar: callbacks as std::function
+ * BM_SpaceTimeAstarInlined: callbacks as policy types, reused workspace
+ * BM_SpaceTimeAstarBuckets: the above with bucket queue
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <solver.hpp>
+
+// expose space-time A*
+struct AstarBench : public MinimumSolver {
+  using MinimumSolver::AstarHeuristics;
+  using MinimumSolver::AstarNode;
+  using MinimumSolver::AstarWorkspace;
+  using MinimumSolver::CheckAstarFin;
+  using MinimumSolver::CheckInvalidAstarNode;
+  using MinimumSolver::CompareAstarNodeBasic;
+  using MinimumSolver::TieKeyAstarNodeBasic;
+  using MinimumSolver::compareAstarNodeBasic;
+  using MinimumSolver::getPathBySpaceTimeAstar;
+};
+
+enum struct Mode { FUNCTION, INLINED, BUCKETS };
+
+template <Mode MODE>
+static void runSpaceTimeAstar(benchmark::State& state)
+{
+  Grid G("random-64-64-20.map");
+  std::mt19937 MT(0);
+  Nodes V = G.getV();
+  DistanceCache cache(&G, G.getNodesSize());
+
+  // instances
+  const int num_queries = 32;
+  std::vector<std::pair<Node*, Node*>> queries;
+  while ((int)queries.size() < num_queries) {
+    Node* s = randomChoose(V, &MT);
+    Node* g = randomChoose(V, &MT);
+    if (s == g || cache.pathDist(s, g) >= G.getNodesSize()) continue;
+    queries.emplace_back(s, g);
+  }
+
+  // blocked space-time cells, 10%
+  const int block_ratio = state.range(0);
+  auto blocked = [&](Node* v, int t) {
+    uint64_t h = (uint64_t)v->id * 2654435761ULL ^ (uint64_t)t * 40503ULL;
+    return (int)(h % 100) < block_ratio;
+  };
+
+  AstarBench::AstarWorkspace W;
+  int64_t expanded = 0;
+  int64_t generated = 0;
+  for (auto _ : state) {
+    for (auto& q : queries) {
+      Node* s = q.first;
+      Node* g = q.second;
+      auto fValue = [&](AstarBench::AstarNode* n) {
+        ++generated;
+        return n->g + cache.pathDist(n->v, g);
+      };
+      auto checkAstarFin = [&](AstarBench::AstarNode* n) {
+        ++expanded;
+        return n->v == g;
+      };
+      auto checkInvalidAstarNode = [&](AstarBench::AstarNode* m) {
+        return blocked(m->v, m->g);
+      };
+      Path path;
+      if (MODE != Mode::FUNCTION) {
+        path = AstarBench::getPathBySpaceTimeAstar(
+            s, g, W, MODE == Mode::BUCKETS, fValue,
+            AstarBench::CompareAstarNodeBasic(),
+            AstarBench::TieKeyAstarNodeBasic(), checkAstarFin,
+            checkInvalidAstarNode);
+      } else {
+        AstarBench::AstarHeuristics f_fValue = fValue;
+        AstarBench::CheckAstarFin f_checkAstarFin = checkAstarFin;
+        AstarBench::CheckInvalidAstarNode f_checkInvalidAstarNode =
+            checkInvalidAstarNode;
+        path = AstarBench::getPathBySpaceTimeAstar(
+            s, g, f_fValue, AstarBench::compareAstarNodeBasic, f_checkAstarFin,
+            f_checkInvalidAstarNode);
+      }
+      benchmark::DoNotOptimize(path);
+    }
+  }
+  state.counters["expanded/s"] =
+      benchmark::Counter(expanded, benchmark::Counter::kIsRate);
+  state.counters["generated/s"] =
+      benchmark::Counter(generated, benchmark::Counter::kIsRate);
+}
+
+static void BM_SpaceTimeAstar(benchmark::State& state)
+{
+  runSpaceTimeAstar<Mode::FUNCTION>(state);
+}
+BENCHMARK(BM_SpaceTimeAstar)->Arg(0)->Arg(10)->Arg(30);
+
+static void BM_SpaceTimeAstarInlined(benchmark::State& state)
+{
+  runSpaceTimeAstar<Mode::INLINED>(state);
+}
+BENCHMARK(BM_SpaceTimeAstarInlined)->Arg(0)->Arg(10)->Arg(30);
+
+static void BM_SpaceTimeAstarBuckets(benchmark::State& state)
+{
+  runSpaceTimeAstar<Mode::BUCKETS>(state);
+}
+BENCHMARK(BM_SpaceTimeAstarBuckets)->Arg(0)->Arg(10)->Arg(30);
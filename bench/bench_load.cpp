@@ -0,0 +1,103 @@
+/*
+ * benchmark of loading instances
+ *
+ * A 512x512 grid with random obstacles and its .pd file (random endpoints)
+ * are generated in a temporary directory, and instance files specify
+ * starts (and goals) of all agents. Time includes loading the map.
+ * BM_LoadMAPF: args are agents
+ * BM_LoadMAPD: args are agents, endpoints are read from the .pd file
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <problem.hpp>
+
+namespace fs = std::filesystem;
+
+static constexpr int SIZE = 512;
+
+// map (and .pd) file, relative to the map directory; created only once
+static std::string getMapFile()
+{
+  static std::string map_file;
+  if (!map_file.empty()) return map_file;
+
+  const fs::path path = fs::temp_directory_path() / "bench_load.map";
+  std::mt19937 MT(0);
+  std::ofstream map(path);
+  std::ofstream pd(path.string() + ".pd");
+  map << "type octile\nheight " << SIZE << "\nwidth " << SIZE << "\nmap\n";
+  const std::string endpoints = "psdea";
+  for (int y = 0; y < SIZE; ++y) {
+    for (int x = 0; x < SIZE; ++x) {
+      const bool obstacle = getRandomFloat(0, 1, &MT) < 0.1;
+      map << (obstacle ? '@' : '.');
+      if (!obstacle && getRandomFloat(0, 1, &MT) < 0.2) {
+        pd << endpoints[getRandomInt(0, endpoints.size() - 1, &MT)];
+      } else {
+        pd << (obstacle ? '@' : '.');
+      }
+    }
+    map << "\n";
+    pd << "\n";
+  }
+  map_file = fs::relative(path, MAP_DIR).string();
+  return map_file;
+}
+
+static void runLoad(benchmark::State& state, const bool mapd)
+{
+  const int num_agents = state.range(0);
+  const std::string map_file = getMapFile();
+
+  // distinct random locations of the grid
+  std::vector<int> cells(SIZE * SIZE);
+  std::iota(cells.begin(), cells.end(), 0);
+  {
+    Grid G(map_file);
+    cells.erase(std::remove_if(cells.begin(), cells.end(),
+                               [&](int id) { return !G.existNode(id); }),
+                cells.end());
+  }
+  std::mt19937 MT(0);
+  std::shuffle(cells.begin(), cells.end(), MT);
+
+  const std::string instance_file =
+      (fs::temp_directory_path() / "bench_load.txt").string();
+  {
+    std::ofstream file(instance_file);
+    file << "# generated by bench_load\n"
+         << "map_file=" << map_file << "\n"
+         << "agents=" << num_agents << "\n"
+         << "seed=0\n"
+         << "max_timestep=1000\n"
+         << "max_comp_time=60000\n";
+    if (mapd) file << "task_frequency=1\ntask_num=1000\n";
+    for (int i = 0; i < num_agents; ++i) {
+      const int s = cells[i];
+      const int g = cells[cells.size() - 1 - i];
+      file << s % SIZE << "," << s / SIZE;
+      if (!mapd) file << "," << g % SIZE << "," << g / SIZE;
+      file << "\n";
+    }
+  }
+
+  for (auto _ : state) {
+    if (mapd) {
+      MAPD_Instance P(instance_file);
+      benchmark::DoNotOptimize(P.getEndpoints().size());
+    } else {
+      MAPF_Instance P(instance_file);
+      benchmark::DoNotOptimize(P.getConfigStart().size());
+    }
+  }
+  fs::remove(instance_file);
+}
+
+static void BM_LoadMAPF(benchmark::State& state) { runLoad(state, false); }
+BENCHMARK(BM_LoadMAPF)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadMAPD(benchmark::State& state) { runLoad(state, true); }
+BENCHMARK(BM_LoadMAPD)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,85 @@
+/*
+ * benchmark of PIBT with many agents
+ *
+ * Random instances on a 256x256 city map, PIBT runs a fixed number of
+ * timesteps. Distance tables are computed once, outside of measurements.
+ * BM_PIBT_MoveTable: candidates ordered by tables of moves, which are
+ *                    computed lazily and kept in the shared tables.
+ * BM_PIBT_Parallel: parallel mode, args are agents and threads.
+ * Counters: timesteps per second.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <pibt.hpp>
+
+static void runPIBT(benchmark::State& state, const bool parallel,
+                    const int num_threads, const bool move_table = false)
+{
+  const int num_agents = state.range(0);
+  const int max_timestep = 64;
+
+  // random instance
+  const std::string instance_file =
+      (std::filesystem::temp_directory_path() /
+       ("bench_pibt_" + std::to_string(num_agents) + ".txt"))
+          .string();
+  {
+    std::ofstream file(instance_file);
+    file << "map_file=Berlin_1_256.map\n"
+         << "agents=" << num_agents << "\n"
+         << "seed=0\n"
+         << "random_problem=1\n"
+         << "max_timestep=" << max_timestep << "\n"
+         << "max_comp_time=3600000\n";
+  }
+  MAPF_Instance P(instance_file);
+  std::filesystem::remove(instance_file);
+
+  // distance tables, shared among iterations
+  Graph* G = P.getG();
+  auto cache = std::make_shared<DistanceCache>(G, G->getNodesSize());
+  cache->complete(P.getConfigGoal());
+
+  int64_t timesteps = 0;
+  for (auto _ : state) {
+    PIBT solver(&P);
+    solver.setDistanceCache(cache);
+    solver.setParallel(parallel);
+    solver.setNumThreads(num_threads);
+    solver.setMoveTable(move_table);
+    solver.solve();
+    timesteps += solver.getSolution().getMakespan();
+  }
+  state.counters["timesteps/s"] =
+      benchmark::Counter(timesteps, benchmark::Counter::kIsRate);
+}
+
+static void BM_PIBT(benchmark::State& state) { runPIBT(state, false, 1); }
+BENCHMARK(BM_PIBT)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_PIBT_MoveTable(benchmark::State& state)
+{
+  runPIBT(state, false, 1, true);
+}
+BENCHMARK(BM_PIBT_MoveTable)
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_PIBT_Parallel(benchmark::State& state)
+{
+  runPIBT(state, true, state.range(1));
+}
+BENCHMARK(BM_PIBT_Parallel)
+    ->Args({10000, 1})
+    ->Args({10000, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
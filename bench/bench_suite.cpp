@@ -0,0 +1,240 @@
+/*
+ * benchmark suite over bundled maps, for regression tracking
+ *
+ * Random instances on maps below; args are the map index and agents.
+ * Distance tables are computed once, outside of measurements,
+ * except for BM_DistanceTable and BM_TP.
+ * BM_PIBT: PIBT runs a fixed number of timesteps, timesteps per second.
+ * BM_HCA: HCA with a timestep limit, agents per second.
+ * BM_TP: TP on warehouse.map, the bundled map with endpoints (.pd),
+ *        args are agents, timesteps per second.
+ * BM_DistanceTable: BFS from goals, args are the map index and goals
+ *                   (0: all nodes, only for small maps), nodes per second.
+ * BM_PlanValidate: validation of plans by PIBT, agent-steps per second.
+ * BM_MakeLog: text (0) or binary (1) log, bytes per second.
+ * A* counters of HCA and TP are reported with -DPIBT2_STATS=ON.
+ * e.g., ./bench_suite --benchmark_out=suite.json --benchmark_out_format=json
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <hca.hpp>
+#include <pibt.hpp>
+#include <tp.hpp>
+
+namespace fs = std::filesystem;
+
+static const std::vector<std::string> MAPS = {
+    "random-64-64-20.map",
+    "warehouse-20-40-10-2-2.map",
+    "den520d.map",
+    "Paris_1_256.map",
+};
+
+// instance with random starts and goals
+static std::unique_ptr<MAPF_Instance> makeInstance(const std::string& map_file,
+                                                   const int num_agents,
+                                                   const int max_timestep)
+{
+  const std::string instance_file =
+      (fs::temp_directory_path() / "bench_suite.txt").string();
+  {
+    std::ofstream file(instance_file);
+    file << "map_file=" << map_file << "\n"
+         << "agents=" << num_agents << "\n"
+         << "seed=0\n"
+         << "random_problem=1\n"
+         << "max_timestep=" << max_timestep << "\n"
+         << "max_comp_time=3600000\n";
+  }
+  auto P = std::make_unique<MAPF_Instance>(instance_file);
+  fs::remove(instance_file);
+  return P;
+}
+
+static std::shared_ptr<DistanceCache> makeDistanceCache(MAPF_Instance* P)
+{
+  Graph* G = P->getG();
+  auto cache = std::make_shared<DistanceCache>(G, G->getNodesSize());
+  cache->complete(P->getConfigGoal());
+  return cache;
+}
+
+// maps x agents (or goals)
+static void applyMaps(benchmark::internal::Benchmark* b,
+                      const std::vector<int>& agents,
+                      const std::string& name = "agents")
+{
+  b->ArgNames({"map", name});
+  for (int m = 0; m < (int)MAPS.size(); ++m) {
+    for (auto n : agents) b->Args({m, n});
+  }
+}
+
+static void addAstarCounters(benchmark::State& state, const Stats& stats)
+{
+  if (!Stats::ENABLED) return;
+  state.counters["expanded/s"] = benchmark::Counter(
+      stats.getCount(Stats::ASTAR_EXPANDED), benchmark::Counter::kIsRate);
+  state.counters["generated/s"] = benchmark::Counter(
+      stats.getCount(Stats::ASTAR_GENERATED), benchmark::Counter::kIsRate);
+}
+
+static void BM_PIBT(benchmark::State& state)
+{
+  const std::string& map_file = MAPS[state.range(0)];
+  auto P = makeInstance(map_file, state.range(1), 64);
+  auto cache = makeDistanceCache(P.get());
+
+  int64_t timesteps = 0;
+  for (auto _ : state) {
+    PIBT solver(P.get());
+    solver.setDistanceCache(cache);
+    solver.solve();
+    timesteps += solver.getSolution().getMakespan();
+  }
+  state.SetLabel(map_file);
+  state.counters["timesteps/s"] =
+      benchmark::Counter(timesteps, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PIBT)
+    ->Apply([](auto* b) { applyMaps(b, {100, 1000}); })
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_HCA(benchmark::State& state)
+{
+  const std::string& map_file = MAPS[state.range(0)];
+  auto P = makeInstance(map_file, state.range(1), 1000);
+  auto cache = makeDistanceCache(P.get());
+
+  int64_t agents = 0;
+  Stats stats;
+  for (auto _ : state) {
+    HCA solver(P.get());
+    solver.setDistanceCache(cache);
+    solver.solve();
+    agents += P->getNum();
+    stats.merge(solver.getStats());
+  }
+  state.SetLabel(map_file);
+  state.counters["agents/s"] =
+      benchmark::Counter(agents, benchmark::Counter::kIsRate);
+  addAstarCounters(state, stats);
+}
+BENCHMARK(BM_HCA)
+    ->Apply([](auto* b) { applyMaps(b, {50, 200}); })
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_TP(benchmark::State& state)
+{
+  const int num_agents = state.range(0);
+  const std::string instance_file =
+      (fs::temp_directory_path() / "bench_suite_mapd.txt").string();
+  {
+    std::ofstream file(instance_file);
+    file << "map_file=warehouse.map\n"
+         << "agents=" << num_agents << "\n"
+         << "seed=0\n"
+         << "max_timestep=10000\n"
+         << "max_comp_time=3600000\n"
+         << "task_frequency=1\n"
+         << "task_num=200\n";
+  }
+
+  int64_t timesteps = 0;
+  Stats stats;
+  for (auto _ : state) {
+    // tasks are consumed by solving
+    state.PauseTiming();
+    MAPD_Instance P(instance_file);
+    state.ResumeTiming();
+    TP solver(&P);
+    solver.solve();
+    timesteps += solver.getSolution().getMakespan();
+    stats.merge(solver.getStats());
+  }
+  fs::remove(instance_file);
+  state.counters["timesteps/s"] =
+      benchmark::Counter(timesteps, benchmark::Counter::kIsRate);
+  addAstarCounters(state, stats);
+}
+BENCHMARK(BM_TP)->Arg(10)->Arg(30)->Unit(benchmark::kMillisecond);
+
+static void BM_DistanceTable(benchmark::State& state)
+{
+  const std::string& map_file = MAPS[state.range(0)];
+  Grid G(map_file);
+  Nodes goals;
+  for (auto v : G.getV()) {
+    if (v != nullptr) goals.push_back(v);
+  }
+  if (state.range(1) > 0) {
+    std::mt19937 MT(0);
+    std::shuffle(goals.begin(), goals.end(), MT);
+    goals.resize(std::min((int)goals.size(), (int)state.range(1)));
+  }
+
+  for (auto _ : state) {
+    DistanceCache cache(&G, G.getNodesSize());
+    cache.complete(goals);
+    benchmark::DoNotOptimize(cache.pathDist(goals.front(), goals.back()));
+  }
+  state.SetLabel(map_file);
+  state.counters["nodes/s"] =
+      benchmark::Counter((double)goals.size() * G.getNodesSize(),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_DistanceTable)
+    ->Apply([](auto* b) { applyMaps(b, {100, 1000}, "goals"); })
+    ->Args({0, 0})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_PlanValidate(benchmark::State& state)
+{
+  const std::string& map_file = MAPS[state.range(0)];
+  auto P = makeInstance(map_file, state.range(1), 64);
+  PIBT solver(P.get());
+  solver.solve();
+  const Plan plan = solver.getSolution();
+
+  for (auto _ : state) {
+    if (!plan.validate(P->getConfigStart())) state.SkipWithError("invalid");
+  }
+  state.SetLabel(map_file);
+  state.counters["agent-steps/s"] = benchmark::Counter(
+      (double)P->getNum() * plan.getMakespan(),
+      benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_PlanValidate)
+    ->Apply([](auto* b) { applyMaps(b, {100, 1000}); })
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MakeLog(benchmark::State& state)
+{
+  const std::string& map_file = MAPS[state.range(0)];
+  const bool binary = state.range(2);
+  auto P = makeInstance(map_file, state.range(1), 64);
+  PIBT solver(P.get());
+  solver.solve();
+
+  const std::string log_file =
+      (fs::temp_directory_path() / "bench_suite_log").string();
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    if (binary) {
+      solver.makeLogBinary(log_file);
+    } else {
+      solver.makeLog(log_file);
+    }
+    bytes += fs::file_size(log_file);
+  }
+  fs::remove(log_file);
+  state.SetLabel(map_file);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_MakeLog)
+    ->ArgNames({"map", "agents", "binary"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
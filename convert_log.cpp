@@ -0,0 +1,66 @@
+#include <getopt.h>
+
+#include <binary_log.hpp>
+#include <default_params.hpp>
+#include <fstream>
+#include <iostream>
+
+void printHelp();
+
+int main(int argc, char* argv[])
+{
+  std::string input_file = "";
+  std::string output_file = DEFAULT_OUTPUT_FILE;
+
+  struct option longopts[] = {
+      {"input", required_argument, 0, 'i'},
+      {"output", required_argument, 0, 'o'},
+      {"help", no_argument, 0, 'h'},
+      {0, 0, 0, 0},
+  };
+
+  // command line args
+  int opt, longindex;
+  opterr = 0;  // ignore getopt error
+  while ((opt = getopt_long(argc, argv, "i:o:h", longopts, &longindex)) !=
+         -1) {
+    switch (opt) {
+      case 'i':
+        input_file = std::string(optarg);
+        break;
+      case 'o':
+        output_file = std::string(optarg);
+        break;
+      case 'h':
+        printHelp();
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  if (input_file.length() == 0) {
+    printHelp();
+    return 0;
+  }
+
+  BinaryLog bin;
+  if (!bin.read(input_file)) {
+    std::cout << "error@convert_log: invalid binary log, " << input_file
+              << std::endl;
+    return 1;
+  }
+  std::ofstream log(output_file, std::ios::out);
+  bin.writeText(log);
+  return 0;
+}
+
+void printHelp()
+{
+  std::cout << "\nUsage: ./convert_log [OPTIONS]\n"
+            << "\nconvert binary log made by -B --binary-log option"
+            << " of mapf/mapd to text\n\n"
+            << "  -i --input [FILE_PATH]        binary log\n"
+            << "  -o --output [FILE_PATH]       output file path\n"
+            << "  -h --help                     help" << std::endl;
+}
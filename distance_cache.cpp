@@ -0,0 +1,99 @@
+#include <getopt.h>
+
+#include <default_params.hpp>
+#include <distance_table.hpp>
+#include <iostream>
+#include <problem.hpp>
+
+void printHelp();
+
+int main(int argc, char* argv[])
+{
+  std::string map_file = "";
+  std::string instance_file = "";
+  std::string output_file = "";
+  int num_threads = DEFAULT_NUM_THREADS;
+
+  struct option longopts[] = {
+      {"map", required_argument, 0, 'm'},
+      {"instance", required_argument, 0, 'i'},
+      {"output", required_argument, 0, 'o'},
+      {"threads", required_argument, 0, 'j'},
+      {"help", no_argument, 0, 'h'},
+      {0, 0, 0, 0},
+  };
+
+  // command line args
+  int opt, longindex;
+  opterr = 0;  // ignore getopt error
+  while ((opt = getopt_long(argc, argv, "m:i:o:j:h", longopts,
+                            &longindex)) != -1) {
+    switch (opt) {
+      case 'm':
+        map_file = std::string(optarg);
+        break;
+      case 'i':
+        instance_file = std::string(optarg);
+        break;
+      case 'o':
+        output_file = std::string(optarg);
+        break;
+      case 'j':
+        num_threads = std::atoi(optarg);
+        break;
+      case 'h':
+        printHelp();
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  if (map_file.length() == 0 && instance_file.length() == 0) {
+    printHelp();
+    return 0;
+  }
+
+  // goals to be stored
+  std::unique_ptr<Graph> G;
+  std::unique_ptr<MAPD_Instance> P;
+  Nodes goals;
+  if (instance_file.length() > 0) {
+    // MAPD, endpoints only
+    P = std::make_unique<MAPD_Instance>(instance_file);
+    goals = P->getPickupLocs();
+    for (auto v : P->getDeliveryLocs()) goals.push_back(v);
+    for (auto v : P->getEndpoints()) goals.push_back(v);
+  } else {
+    // all nodes
+    G = std::make_unique<Grid>(map_file);
+    goals = G->getV();
+  }
+  Graph* graph = (P != nullptr) ? P->getG() : G.get();
+
+  // distances are not capped, usable with any timestep limit
+  auto t_start = Time::now();
+  DistanceCache cache(graph, DistanceTable::NIL);
+  cache.complete(goals, num_threads);
+  if (output_file.length() == 0) {
+    output_file = DistanceCache::getCacheFileName(graph);
+  }
+  cache.save(output_file);
+
+  std::cout << "save " << cache.size() << " tables as " << output_file
+            << ", comp_time(ms)=" << getElapsedTime(t_start) << std::endl;
+  return 0;
+}
+
+void printHelp()
+{
+  std::cout << "\nUsage: ./distance_cache [OPTIONS]\n"
+            << "\nbuild distance tables used by -C --distance-cache option"
+            << " of mapf/mapd\n\n"
+            << "  -m --map [MAP_FILE]           all nodes of the map\n"
+            << "  -i --instance [FILE_PATH]     endpoints of MAPD instance\n"
+            << "  -o --output [FILE_PATH]       output file path,"
+            << " default: next to the map\n"
+            << "  -j --threads [INT]            number of threads, 0: all\n"
+            << "  -h --help                     help" << std::endl;
+}
@@ -31,16 +31,32 @@ int main(int argc, char* argv[])
       {"time-limit", required_argument, 0, 'T'},
       {"log-short", no_argument, 0, 'L'},
       {"use-distance-table", no_argument, 0, 'd'},
+      {"threads", required_argument, 0, 'j'},
+      {"distance-cache", no_argument, 0, 'C'},
+      {"bucket-queue", no_argument, 0, 'b'},
+      {"binary-log", no_argument, 0, 'B'},
+      {"compact-plan", no_argument, 0, 'M'},
+      {"stats", required_argument, 0, 'J'},
+      {"stream", required_argument, 0, 'S'},
+      {"stream-keep", no_argument, 0, 'K'},
       {0, 0, 0, 0},
   };
   bool log_short = false;
   int max_comp_time = -1;
+  bool load_distance_cache = false;
+  bool use_bucket_queue = false;
+  bool binary_log = false;
+  bool compact_plan = false;
+  std::string stats_file = "";
   bool use_distance_table = false;
+  int num_threads = DEFAULT_NUM_THREADS;
+  int stream_chunk = 0;
+  bool stream_keep = false;
 
   // command line args
   int opt, longindex;
   opterr = 0;  // ignore getopt error
-  while ((opt = getopt_long(argc, argv, "i:o:s:vhT:Ld", longopts,
+  while ((opt = getopt_long(argc, argv, "i:o:s:vhT:Ldj:CbS:KBMJ:", longopts,
                             &longindex)) != -1) {
     switch (opt) {
       case 'i':
@@ -67,6 +83,30 @@ int main(int argc, char* argv[])
       case 'd':
         use_distance_table = true;
         break;
+      case 'j':
+        num_threads = std::atoi(optarg);
+        break;
+      case 'C':
+        load_distance_cache = true;
+        break;
+      case 'b':
+        use_bucket_queue = true;
+        break;
+      case 'B':
+        binary_log = true;
+        break;
+      case 'M':
+        compact_plan = true;
+        break;
+      case 'J':
+        stats_file = std::string(optarg);
+        break;
+      case 'S':
+        stream_chunk = std::atoi(optarg);
+        break;
+      case 'K':
+        stream_keep = true;
+        break;
       default:
         break;
     }
@@ -79,6 +119,13 @@ int main(int argc, char* argv[])
     return 0;
   }
 
+  // known before solving, binary logs are made from the whole plan
+  if (stream_chunk > 0 && binary_log) {
+    std::cout << "error@mapd: --stream cannot be used with --binary-log"
+              << std::endl;
+    return 0;
+  }
+
   // set problem
   auto P = MAPD_Instance(instance_file);
 
@@ -89,18 +136,36 @@ int main(int argc, char* argv[])
   auto solver =
       getSolver(solver_name, &P, verbose, argc, argv_copy, use_distance_table);
   solver->setLogShort(log_short);
+  solver->setLoadDistanceCache(load_distance_cache);
+  solver->setBucketQueue(use_bucket_queue);
+  solver->setNumThreads(num_threads);
+  solver->setCompactPlan(compact_plan);
+  if (stream_chunk > 0) {
+    solver->setPlanStream(output_file + ".stream", stream_chunk,
+                          !stream_keep);
+  }
   solver->solve();
-  if (solver->succeed() && !solver->getSolution().validate(&P)) {
+  // dropped plans keep only the last configuration
+  if (stream_chunk > 0 && !stream_keep) {
+    std::cout << "warn@mapd: validation is skipped for streamed plans"
+              << std::endl;
+  } else if (solver->succeed() &&
+             !solver->getSolution().validate(&P, num_threads)) {
     std::cout << "error@mapd: invalid results" << std::endl;
     return 0;
   }
   solver->printResult();
 
   // output result
-  solver->makeLog(output_file);
+  if (binary_log) {
+    solver->makeLogBinary(output_file);
+  } else {
+    solver->makeLog(output_file);
+  }
   if (verbose) {
     std::cout << "save result as " << output_file << std::endl;
   }
+  if (!stats_file.empty()) solver->makeStatsFile(stats_file);
 
   return 0;
 }
@@ -135,9 +200,25 @@ void printHelp()
       << "  -v --verbose                  print additional info\n"
       << "  -h --help                     help\n"
       << "  -d --use-distance-table       use pre-computed distance table\n"
+      << "  -C --distance-cache           load distance tables built by "
+         "./distance_cache\n"
+      << "  -j --threads [INT]            threads of distance table and "
+         "validation, 0: all\n"
       << "  -s --solver [SOLVER_NAME]     solver, choose from the below\n"
       << "  -T --time-limit [INT]         max computation time (ms)\n"
       << "  -L --log-short                use short log\n"
+      << "  -b --bucket-queue             use bucket queue in A*, "
+         "tie-breaking may differ\n"
+      << "  -S --stream [INT]             write solution every INT timesteps, "
+         "bounded memory\n"
+      << "  -K --stream-keep              keep streamed solution in memory, "
+         "for validation\n"
+      << "  -B --binary-log               output compact binary log, "
+         "see ./convert_log\n"
+      << "  -M --compact-plan             keep solution as moves, "
+         "less memory\n"
+      << "  -J --stats [FILE_PATH]        write timers and counters as JSON, "
+         "see PIBT2_STATS\n"
       << "\nSolver Options:" << std::endl;
   // each solver
   PIBT_MAPD::printHelp();
@@ -33,16 +33,30 @@ int main(int argc, char* argv[])
       {"time-limit", required_argument, 0, 'T'},
       {"log-short", no_argument, 0, 'L'},
       {"make-scen", no_argument, 0, 'P'},
+      {"lazy-distance-table", no_argument, 0, 'l'},
+      {"distance-cache", no_argument, 0, 'C'},
+      {"bucket-queue", no_argument, 0, 'b'},
+      {"binary-log", no_argument, 0, 'B'},
+      {"compact-plan", no_argument, 0, 'M'},
+      {"stats", required_argument, 0, 'J'},
+      {"threads", required_argument, 0, 'j'},
       {0, 0, 0, 0},
   };
   bool make_scen = false;
   bool log_short = false;
+  bool lazy_distance_table = false;
   int max_comp_time = -1;
+  bool load_distance_cache = false;
+  bool use_bucket_queue = false;
+  bool binary_log = false;
+  bool compact_plan = false;
+  std::string stats_file = "";
+  int num_threads = DEFAULT_NUM_THREADS;
 
   // command line args
   int opt, longindex;
   opterr = 0;  // ignore getopt error
-  while ((opt = getopt_long(argc, argv, "i:o:s:vhPT:L", longopts,
+  while ((opt = getopt_long(argc, argv, "i:o:s:vhPT:LlCbBMJ:j:", longopts,
                             &longindex)) != -1) {
     switch (opt) {
       case 'i':
@@ -69,6 +83,27 @@ int main(int argc, char* argv[])
       case 'T':
         max_comp_time = std::atoi(optarg);
         break;
+      case 'l':
+        lazy_distance_table = true;
+        break;
+      case 'C':
+        load_distance_cache = true;
+        break;
+      case 'b':
+        use_bucket_queue = true;
+        break;
+      case 'B':
+        binary_log = true;
+        break;
+      case 'M':
+        compact_plan = true;
+        break;
+      case 'J':
+        stats_file = std::string(optarg);
+        break;
+      case 'j':
+        num_threads = std::atoi(optarg);
+        break;
       default:
         break;
     }
@@ -96,18 +131,29 @@ int main(int argc, char* argv[])
   // solve
   auto solver = getSolver(solver_name, &P, verbose, argc, argv_copy);
   solver->setLogShort(log_short);
+  solver->setLoadDistanceCache(load_distance_cache);
+  solver->setBucketQueue(use_bucket_queue);
+  solver->setLazyDistanceTable(lazy_distance_table);
+  solver->setCompactPlan(compact_plan);
+  solver->setNumThreads(num_threads);
   solver->solve();
-  if (solver->succeed() && !solver->getSolution().validate(&P)) {
+  if (solver->succeed() &&
+      !solver->getSolution().validate(&P, num_threads)) {
     std::cout << "error@mapf: invalid results" << std::endl;
     return 0;
   }
   solver->printResult();
 
   // output result
-  solver->makeLog(output_file);
+  if (binary_log) {
+    solver->makeLogBinary(output_file);
+  } else {
+    solver->makeLog(output_file);
+  }
   if (verbose) {
     std::cout << "save result as " << output_file << std::endl;
   }
+  if (!stats_file.empty()) solver->makeStatsFile(stats_file);
 
   return 0;
 }
@@ -146,9 +192,23 @@ void printHelp()
             << "  -h --help                     help\n"
             << "  -s --solver [SOLVER_NAME]     solver, choose from the below\n"
             << "  -T --time-limit [INT]         max computation time (ms)\n"
-            << "  -L --log-short                use short log"
+            << "  -L --log-short                use short log\n"
             << "  -P --make-scen                make scenario file using "
-               "random starts/goals"
+               "random starts/goals\n"
+            << "  -l --lazy-distance-table      expand BFS of distance table "
+               "on demand\n"
+            << "  -C --distance-cache           load distance tables built by "
+               "./distance_cache\n"
+            << "  -b --bucket-queue             use bucket queue in A*, "
+               "tie-breaking may differ\n"
+            << "  -B --binary-log               output compact binary log, "
+               "see ./convert_log\n"
+            << "  -M --compact-plan             keep solution as moves, "
+               "less memory (PIBT)\n"
+            << "  -J --stats [FILE_PATH]        write timers and counters as "
+               "JSON, see PIBT2_STATS\n"
+            << "  -j --threads [INT]            threads of distance table and "
+               "validation, 0: all"
             << "\n\nSolver Options:" << std::endl;
   // each solver
   PIBT::printHelp();
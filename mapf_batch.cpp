@@ -0,0 +1,275 @@
+#include <getopt.h>
+
+#include <charconv>
+#include <default_params.hpp>
+#include <fstream>
+#include <hca.hpp>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <pibt.hpp>
+#include <pibt_plus.hpp>
+#include <problem.hpp>
+#include <push_and_swap.hpp>
+#include <sstream>
+#include <thread_pool.hpp>
+#include <unordered_map>
+#include <vector>
+
+// one line of the list, i.e., one run
+struct Run {
+  std::string instance_file;
+  std::string solver_name;
+  int seed = -1;                     // -1 -> seed of the instance file
+  std::vector<std::string> options;  // solver options
+  std::unique_ptr<MAPF_Instance> P;
+  std::shared_ptr<DistanceCache> cache;
+
+  // result
+  bool solved = false;
+  int soc = 0;
+  int lb_soc = 0;
+  int makespan = 0;
+  int lb_makespan = 0;
+  int comp_time = 0;
+};
+
+void printHelp();
+bool readList(const std::string& list_file, std::vector<Run>& runs);
+std::unique_ptr<MAPF_Solver> getSolver(Run& run);
+
+int main(int argc, char* argv[])
+{
+  std::string list_file = "";
+  std::string output_file = "./result.csv";
+  bool verbose = false;
+  int max_comp_time = -1;
+  int num_threads = DEFAULT_NUM_THREADS;
+
+  struct option longopts[] = {
+      {"list", required_argument, 0, 'i'},
+      {"output", required_argument, 0, 'o'},
+      {"verbose", no_argument, 0, 'v'},
+      {"help", no_argument, 0, 'h'},
+      {"time-limit", required_argument, 0, 'T'},
+      {"threads", required_argument, 0, 'j'},
+      {0, 0, 0, 0},
+  };
+
+  // command line args
+  int opt, longindex;
+  opterr = 0;  // ignore getopt error
+  while ((opt = getopt_long(argc, argv, "i:o:vhT:j:", longopts,
+                            &longindex)) != -1) {
+    switch (opt) {
+      case 'i':
+        list_file = std::string(optarg);
+        break;
+      case 'o':
+        output_file = std::string(optarg);
+        break;
+      case 'v':
+        verbose = true;
+        break;
+      case 'h':
+        printHelp();
+        return 0;
+      case 'T':
+        max_comp_time = std::atoi(optarg);
+        break;
+      case 'j':
+        num_threads = std::atoi(optarg);
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (list_file.length() == 0) {
+    printHelp();
+    return 0;
+  }
+
+  std::vector<Run> runs;
+  if (!readList(list_file, runs)) return 0;
+
+  // load instances, each map only once
+  auto t_start = Time::now();
+  std::unordered_map<std::string, std::unique_ptr<Grid>> maps;
+  auto load_map = [&](const std::string& map_file) -> Graph* {
+    auto& G = maps[map_file];
+    if (G == nullptr) G = std::make_unique<Grid>(map_file);
+    return G.get();
+  };
+  for (auto& run : runs) {
+    run.P =
+        std::make_unique<MAPF_Instance>(run.instance_file, load_map, run.seed);
+    if (max_comp_time != -1) run.P->setMaxCompTime(max_comp_time);
+  }
+
+  // distance tables, shared among runs with the same map and timestep limit;
+  // completed in advance, then only read during runs
+  std::map<std::pair<Graph*, int>, std::shared_ptr<DistanceCache>> caches;
+  std::map<std::pair<Graph*, int>, Nodes> goals;
+  for (auto& run : runs) {
+    const auto key = std::make_pair(run.P->getG(), run.P->getMaxTimestep());
+    auto& cache = caches[key];
+    if (cache == nullptr) {
+      cache = std::make_shared<DistanceCache>(key.first, key.second);
+    }
+    run.cache = cache;
+    for (auto g : run.P->getConfigGoal()) goals[key].push_back(g);
+  }
+  for (auto& itr : caches) itr.second->complete(goals[itr.first], num_threads);
+  if (verbose) {
+    std::cout << "loaded " << runs.size() << " instances on " << maps.size()
+              << " maps, elapsed: " << getElapsedTime(t_start) << " ms"
+              << std::endl;
+  }
+
+  // solve, each run on one thread
+  std::mutex mtx;
+  int num_finished = 0;
+  ThreadPool pool(num_threads);
+  pool.parallelFor(runs.size(), [&](int k) {
+    auto& run = runs[k];
+    std::unique_ptr<MAPF_Solver> solver;
+    {
+      // solver options are parsed by getopt, not thread-safe
+      std::lock_guard<std::mutex> lock(mtx);
+      solver = getSolver(run);
+    }
+    solver->setDistanceCache(run.cache);
+    solver->solve();
+    const Plan& solution = solver->getSolution();
+    run.solved = solver->succeed();
+    if (run.solved && !solution.validate(run.P.get())) {
+      std::lock_guard<std::mutex> lock(mtx);
+      std::cout << "error@mapf_batch: invalid results, " << run.instance_file
+                << std::endl;
+      run.solved = false;
+    }
+    run.soc = solution.getSOC();
+    run.lb_soc = solver->getLowerBoundSOC();
+    run.makespan = solution.getMakespan();
+    run.lb_makespan = solver->getLowerBoundMakespan();
+    run.comp_time = solver->getCompTime();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    ++num_finished;
+    if (verbose) {
+      std::cout << "[" << num_finished << "/" << runs.size() << "] "
+                << run.instance_file << ", " << solver->getSolverName()
+                << ", solved=" << run.solved << ", soc=" << run.soc
+                << ", makespan=" << run.makespan
+                << ", comp_time(ms)=" << run.comp_time << std::endl;
+    }
+  });
+
+  // output result
+  std::ofstream log(output_file);
+  log << "instance,map_file,agents,seed,solver,solved,soc,lb_soc,makespan,"
+         "lb_makespan,comp_time\n";
+  for (auto& run : runs) {
+    std::string solver = run.solver_name;
+    for (auto& option : run.options) solver += " " + option;
+    const std::string seed = run.seed >= 0 ? std::to_string(run.seed) : "";
+    log << run.instance_file << ","
+        << static_cast<Grid*>(run.P->getG())->getMapFileName() << ","
+        << run.P->getNum() << "," << seed << "," << solver << ","
+        << run.solved << "," << run.soc << "," << run.lb_soc << ","
+        << run.makespan << "," << run.lb_makespan << "," << run.comp_time
+        << "\n";
+  }
+  log.close();
+  if (verbose) {
+    std::cout << "save result as " << output_file << ", elapsed: "
+              << getElapsedTime(t_start) << " ms" << std::endl;
+  }
+
+  return 0;
+}
+
+// INSTANCE-FILE [SOLVER [SEED [SOLVER-OPTIONS...]]] per line
+bool readList(const std::string& list_file, std::vector<Run>& runs)
+{
+  std::ifstream file(list_file);
+  if (!file) {
+    std::cout << "error@mapf_batch: file " << list_file << " is not found."
+              << std::endl;
+    return false;
+  }
+  std::string line;
+  while (getline(file, line)) {
+    std::istringstream tokens(line);
+    Run run;
+    if (!(tokens >> run.instance_file) || run.instance_file[0] == '#') {
+      continue;
+    }
+    if (!(tokens >> run.solver_name)) run.solver_name = "PIBT";
+    std::string seed;
+    if ((tokens >> seed) && seed != "-") {
+      // non-negative and within int
+      auto res = std::from_chars(seed.data(), seed.data() + seed.size(),
+                                 run.seed);
+      if (res.ec != std::errc() || res.ptr != seed.data() + seed.size() ||
+          run.seed < 0) {
+        std::cout << "error@mapf_batch: invalid seed, " << line << std::endl;
+        return false;
+      }
+    }
+    std::string option;
+    while (tokens >> option) run.options.push_back(option);
+    runs.push_back(std::move(run));
+  }
+  return true;
+}
+
+std::unique_ptr<MAPF_Solver> getSolver(Run& run)
+{
+  MAPF_Instance* P = run.P.get();
+  std::unique_ptr<MAPF_Solver> solver;
+  if (run.solver_name == "PIBT") {
+    solver = std::make_unique<PIBT>(P);
+  } else if (run.solver_name == "HCA") {
+    solver = std::make_unique<HCA>(P);
+  } else if (run.solver_name == "PIBT_PLUS") {
+    solver = std::make_unique<PIBT_PLUS>(P);
+  } else if (run.solver_name == "PushAndSwap") {
+    solver = std::make_unique<PushAndSwap>(P);
+  } else {
+    std::cout << "warn@mapf_batch: "
+              << "unknown solver name, " + run.solver_name +
+                     ", continue by PIBT"
+              << std::endl;
+    run.solver_name = "PIBT";
+    solver = std::make_unique<PIBT>(P);
+  }
+  // solver options, the same as mapf
+  std::vector<char*> argv = {const_cast<char*>("mapf_batch")};
+  for (auto& option : run.options) argv.push_back(&option[0]);
+  argv.push_back(nullptr);
+  solver->setParams(argv.size() - 1, argv.data());
+  return solver;
+}
+
+void printHelp()
+{
+  std::cout
+      << "\nUsage: ./mapf_batch [OPTIONS]\n"
+      << "\nSolve many MAPF instances in one process. Maps are loaded once\n"
+      << "and distance tables are shared among instances.\n\n"
+      << "  -i --list [FILE_PATH]         list of runs, each line is\n"
+      << "                                INSTANCE-FILE [SOLVER [SEED "
+         "[SOLVER-OPTIONS...]]]\n"
+      << "                                SOLVER: PIBT (default), HCA, "
+         "PIBT_PLUS, PushAndSwap\n"
+      << "                                SEED: '-' for the instance file\n"
+      << "  -o --output [FILE_PATH]       csv file of results\n"
+      << "  -v --verbose                  print progress\n"
+      << "  -h --help                     help\n"
+      << "  -T --time-limit [INT]         max computation time (ms)\n"
+      << "  -j --threads [INT]            runs solved in parallel, 0: all\n"
+      << "\nComputation time is measured per run, hence it is affected by\n"
+      << "other runs with multiple threads." << std::endl;
+}
@@ -0,0 +1,58 @@
+/*
+ * compact binary format of results, an alternative to the text log
+ *
+ * Layout, integers are unsigned LEB128 varints unless noted:
+ * - "PIBT2LOG" (8 bytes), version, kind (MAPF or MAPD)
+ * - header: length and bytes of the text lines before the solution,
+ *   e.g., "solver=PIBT\n", kept verbatim
+ * - has_solution (0 when log-short), then, only when it is 1,
+ * - width of the grid, agents, timesteps (makespan + 1, 0 when failed)
+ * - MAPF: starts and goals as node-ids
+ *   MAPD: starts, then tasks (id, pickup, delivery, appear, finished + 1)
+ * - paths, agent by agent: the first node-id, then zigzag deltas of
+ *   node-ids; a zero delta is followed by the length of the wait
+ * - MAPD only: targets and tasks (id + 1, 0 for none) of each agent as
+ *   (value, run-length) pairs
+ * The text log is restored by writeText, without the map.
+ */
+
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct BinaryLog {
+  static constexpr char MAGIC[] = "PIBT2LOG";
+  static constexpr int VERSION = 1;
+  enum Kind { MAPF = 0, MAPD = 1 };
+
+  struct TaskRecord {
+    int id;
+    int pickup;    // node-id
+    int delivery;  // node-id
+    int appear;
+    int finished;
+  };
+
+  int kind = MAPF;
+  std::string header;         // text lines of basic info
+  bool has_solution = false;  // false -> log-short
+  int width = 0;              // node-id = width * y + x
+  int num_agents = 0;
+  int num_timesteps = 0;
+  std::vector<int> starts;        // agent -> node-id
+  std::vector<int> goals;         // agent -> node-id, MAPF
+  std::vector<TaskRecord> tasks;  // closed tasks, MAPD
+  // agent, timestep -> node-id / node-id of target / task-id (or -1)
+  std::vector<std::vector<int>> paths;
+  std::vector<std::vector<int>> targets;   // MAPD
+  std::vector<std::vector<int>> task_ids;  // MAPD
+
+  // return false when failed
+  bool write(const std::string& filename) const;
+  bool read(const std::string& filename);
+
+  // the same as the text log of solvers
+  void writeText(std::ostream& os) const;
+};
@@ -0,0 +1,162 @@
+/*
+ * distance from every node to one goal, by breadth first search
+ *
+ * The search is resumable.
+ * In lazy mode, BFS is expanded only until the queried node is settled,
+ * hence solvers pay only for nodes they actually touch.
+ *
+ * Distances are stored as 16-bit integers in one contiguous, cache-line
+ * aligned array; nodes farther than 65534 are regarded as unreachable.
+ * Completed tables can also refer to a memory-mapped cache file.
+ *
+ * Optionally, a compact ordering of moves is derived from the table;
+ * for each node, one byte keeps 2 bits per neighbor, i.e.,
+ * (distance of the neighbor) - (distance of the node) + 1, in {0, 1, 2}.
+ * Sorting moves by these keys is the same as sorting by distances.
+ * Keys are computed lazily, only for nodes that are actually queried.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <graph.hpp>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class DistanceTable
+{
+public:
+  using Dist = uint16_t;
+  static constexpr Dist NIL = std::numeric_limits<Dist>::max();
+  static constexpr int ALIGNMENT = 64;  // cache line
+
+private:
+  struct FreeDeleter {
+    void operator()(Dist* p) const { std::free(p); }
+  };
+
+  Graph* const G;                                 // graph
+  Node* const g;                                  // goal
+  const int max_dist;                             // used for unreachable nodes
+  Dist* table;                                    // node-id -> distance
+  std::unique_ptr<Dist[], FreeDeleter> storage;   // nullptr when mapped
+  std::shared_ptr<const void> mapping;            // keep mapped file alive
+  std::vector<Node*> OPEN;                        // queue of BFS
+  int head;                                       // front of OPEN
+  std::unique_ptr<std::atomic<uint8_t>[]> moves;  // node-id -> keys of moves
+  std::once_flag moves_allocated;                 // moves are allocated once
+
+  // expand one node of OPEN
+  void expand();
+
+  // keys of moves at v from distances of v and its neighbors
+  uint8_t computeMoves(Node* const v);
+
+public:
+  DistanceTable(Graph* _G, Node* _g, const int _max_dist);
+  // completed table on memory-mapped data
+  DistanceTable(Graph* _G, Node* _g, const int _max_dist, const Dist* _table,
+                std::shared_ptr<const void> _mapping);
+  ~DistanceTable() {}
+
+  // get path distance v -> goal
+  int get(Node* const v)
+  {
+    while (table[v->id] == NIL && head < (int)OPEN.size()) expand();
+    const int d = table[v->id];
+    return (d == NIL || d > max_dist) ? max_dist : d;
+  }
+
+  // raw data, node-id -> distance, NIL: unreachable
+  const Dist* data() const { return table; }
+
+  // expand until all reachable nodes are settled
+  void complete();
+
+  // whether BFS has already finished
+  bool completed() const { return head >= (int)OPEN.size(); }
+
+  // keys of moves, up to MAX_MOVES neighbors per node
+  static constexpr int MAX_MOVES = 4;
+  static int getMoveKey(const uint8_t moves, const int k)
+  {
+    return (moves >> (2 * k)) & 3;
+  }
+  // not computed yet, never appears since keys are in {0, 1, 2}
+  static constexpr uint8_t MOVES_NIL = 0xFF;
+  // prepare keys of moves, required before getMoves; thread-safe
+  void initMoves();
+  // keys of moves at v, computed at the first query;
+  // thread-safe for completed tables
+  uint8_t getMoves(Node* const v)
+  {
+    uint8_t keys = moves[v->id].load(std::memory_order_relaxed);
+    if (keys == MOVES_NIL) {
+      keys = computeMoves(v);
+      moves[v->id].store(keys, std::memory_order_relaxed);
+    }
+    return keys;
+  }
+
+  Node* getGoal() const { return g; }
+};
+
+using DistanceTables = std::vector<std::shared_ptr<DistanceTable>>;
+
+/*
+ * distance tables keyed by goal node-id
+ *
+ * Agents with identical goals share one table, i.e., memory usage is
+ * O(distinct goals * V) instead of O(agents * V).
+ * Tables are reference-counted; unused ones are removed by release().
+ * Not thread-safe, except for reading tables completed in advance, e.g.,
+ * by complete(), which can be shared among solvers running in parallel.
+ */
+class DistanceCache
+{
+private:
+  Graph* const G;
+  const int max_dist;     // distance of unreachable (or too far) nodes
+  DistanceTables tables;  // goal-id -> table, nullptr: not created yet
+
+  void create(Node* const g);
+
+public:
+  DistanceCache(Graph* _G, const int _max_dist);
+  ~DistanceCache() {}
+
+  // get table of goal g, created if not exist
+  std::shared_ptr<DistanceTable> get(Node* const g);
+
+  // get path distance s -> g
+  int pathDist(Node* const s, Node* const g)
+  {
+    auto& table = tables[g->id];
+    if (table == nullptr) create(g);
+    return table->get(s);
+  }
+
+  // run BFS for all goals until completion, in parallel
+  void complete(const Nodes& goals, const int num_threads = 1);
+
+  // remove tables that are referenced only by the cache
+  void release();
+
+  // persistent cache, a binary file next to the map,
+  // keyed by content hash of the map file and its .pd file,
+  // empty when G is not a grid
+  static std::string getCacheFileName(Graph* const G);
+  // store completed tables
+  void save(const std::string& filename) const;
+  // memory-map stored tables, return false when unavailable
+  bool load(const std::string& filename);
+
+  // number of stored tables
+  int size() const;
+
+  Graph* getG() const { return G; }
+  int getMaxDist() const { return max_dist; }
+};
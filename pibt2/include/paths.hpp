@@ -3,12 +3,22 @@
 
 /*
  * array of path
+ *
+ * For conflict counting, locations are also kept as node ids in a
+ * timestep-major array, built on demand; agents are compared with
+ * contiguous ids and occupancy of nodes, i.e., linear in agents.
  */
 
 struct Paths {
 private:
   std::vector<Path> paths;  // main
-  int makespan;
+  int makespan = 0;
+
+  // ids[t * size() + i] -> node id of agent i at t, -1 for empty paths
+  mutable std::vector<int> ids;
+  mutable bool ids_valid = false;
+  mutable int max_id = -1;
+  void buildIds() const;
 
 public:
   Paths() {}
@@ -16,7 +26,7 @@ public:
   ~Paths() {}
 
   // agent -> path
-  Path get(int i) const;
+  const Path& get(int i) const;
 
   // agent, timestep -> location
   Node* get(int i, int t) const;
@@ -9,7 +9,9 @@
  */
 
 #pragma once
+#include "priority_order.hpp"
 #include "solver.hpp"
+#include "thread_pool.hpp"
 
 class PIBT : public MAPF_Solver
 {
@@ -17,28 +19,77 @@ public:
   static const std::string SOLVER_NAME;
 
 private:
-  // PIBT agent
-  struct Agent {
-    int id;
-    Node* v_now;        // current location
-    Node* v_next;       // next location
-    Node* g;            // goal
-    int elapsed;        // eta
-    int init_d;         // initial distance
-    float tie_breaker;  // epsilon, tie-breaker
-  };
-  using Agents = std::vector<Agent*>;
+  // PIBT agents, structure of arrays indexed by agent-id
+  Nodes v_now;                      // current location
+  Nodes v_next;                     // next location
+  Nodes goals;                      // goal
+  std::vector<int> elapsed;         // eta
+  std::vector<int> init_d;          // initial distance
+  std::vector<float> tie_breakers;  // epsilon, tie-breaker
+  PriorityOrder order;              // by elapsed, init_d, tie-breaker
 
-  // <node-id, agent>, whether the node is occupied or not
+  // <node-id, agent-id>, whether the node is occupied or not
   // work as reservation table
-  Agents occupied_now;
-  Agents occupied_next;
+  std::vector<int> occupied_now;
+  std::vector<int> occupied_next;
+
+  // candidates of next locations, i.e., neighbors and staying
+  // grids are four-connected, allocated on the stack
+  static constexpr int MAX_CANDIDATES = 5;
+  // sorted candidates of agent i, return the number of candidates
+  template <typename RNG>
+  int getCandidates(const int i, Node** C, RNG& rng);
+
+  // call of priority inheritance, i: agent, j: parent (NIL for root)
+  struct Frame {
+    int i;
+    int j;
+    Node* C[MAX_CANDIDATES];  // candidates
+    int num;                  // number of candidates
+    int k;                    // next candidate
+  };
+  using Stack = std::vector<Frame>;
+  Stack stack;  // explicit call stack, at most agents
+
+  /*
+   * parallel mode
+   * Agents whose candidates (neighbors and staying) can overlap are
+   * united into one cluster at each timestep. Clusters share neither
+   * agents nor nodes to be reserved, hence they are planned concurrently.
+   * Each cluster shuffles candidates with its own generator seeded by
+   * the timestep and its first agent, so that results do not depend on
+   * the number of threads. The results differ from the sequential mode.
+   */
+  using ClusterRNG = std::minstd_rand;
+  std::vector<int> uf_parent;     // agent-id -> parent, union-find
+  std::vector<int> claimed;       // node-id -> agent-id of candidate
+  std::vector<int> cluster_id;    // root agent-id -> cluster index
+  std::vector<int> cluster_head;  // cluster index -> offset in members
+  std::vector<int> members;       // agents of clusters, in priority order
+  int findCluster(int i);
+  void uniteCluster(const int i, const int j);
+  // partition agents, return the number of clusters
+  int makeClusters(const std::vector<int>& sorted);
+  void planInParallel(const std::vector<int>& sorted, ThreadPool& pool,
+                      std::vector<Stack>& stacks,
+                      std::vector<Stats>& worker_stats);
+
+  // agent-id -> table with keys of moves, see DistanceTable::getMoves
+  std::vector<DistanceTable*> move_tables;
 
   // option
   bool disable_dist_init = false;
+  bool recursive_inheritance = false;  // reference implementation
+  bool parallel = false;               // plan clusters in parallel
+  bool use_move_table = false;         // order candidates by move_tables
 
   // result of priority inheritance: true -> valid, false -> invalid
-  bool funcPIBT(Agent* ai, Agent* aj = nullptr);
+  bool funcPIBT(const int i);
+  template <typename RNG>
+  bool funcPIBTIterative(const int i, Stack& stack, RNG& rng,
+                         Stats& counter);
+  // the original, recursive version
+  bool funcPIBTRecursive(const int i, const int j = NIL);
 
   // main
   void run();
@@ -48,5 +99,11 @@ public:
   ~PIBT() {}
 
   void setParams(int argc, char* argv[]);
+  void setRecursiveInheritance(bool _recursive)
+  {
+    recursive_inheritance = _recursive;
+  }
+  void setParallel(bool _parallel) { parallel = _parallel; }
+  void setMoveTable(bool _use) { use_move_table = _use; }
   static void printHelp();
 };
@@ -1,4 +1,5 @@
 #pragma once
+#include "priority_order.hpp"
 #include "solver.hpp"
 
 class PIBT_MAPD : public MAPD_Solver
@@ -25,8 +26,32 @@ private:
   Agents occupied_now;
   Agents occupied_next;
 
+  // by task (assigned first), elapsed, tie-breaker
+  PriorityOrder order;
+
+  // candidates of next locations, i.e., neighbors and staying
+  // grids are four-connected, allocated on the stack
+  static constexpr int MAX_CANDIDATES = 5;
+  // sorted candidates of ai, return the number of candidates
+  int getCandidates(Agent* ai, Node** C);
+
+  // call of priority inheritance, ai: agent, aj: parent (nullptr for root)
+  struct Frame {
+    Agent* ai;
+    Agent* aj;
+    Node* C[MAX_CANDIDATES];  // candidates
+    int num;                  // number of candidates
+    int k;                    // next candidate
+  };
+  std::vector<Frame> stack;  // explicit call stack, at most agents
+
+  // option
+  bool recursive_inheritance = false;  // reference implementation
+
   // result of priority inheritance: true -> valid, false -> invalid
-  bool funcPIBT(Agent* ai, Agent* aj = nullptr);
+  bool funcPIBT(Agent* ai);
+  // the original, recursive version
+  bool funcPIBTRecursive(Agent* ai, Agent* aj = nullptr);
 
   // main
   void run();
@@ -35,5 +60,10 @@ public:
   PIBT_MAPD(MAPD_Instance* _P, bool _use_distance_table = false);
   ~PIBT_MAPD() {}
 
+  void setRecursiveInheritance(bool _recursive)
+  {
+    recursive_inheritance = _recursive;
+  }
+
   static void printHelp();
 };
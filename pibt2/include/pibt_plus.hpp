@@ -16,10 +16,12 @@ public:
 
   void run();
 
+protected:
+  void makeLogBasicInfo(std::ostream& log);
+
 public:
   PIBT_PLUS(MAPF_Instance* _P);
   ~PIBT_PLUS() {}
 
-  void makeLog(const std::string& logfile);
   static void printHelp();
 };
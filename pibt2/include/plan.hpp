@@ -1,17 +1,73 @@
 #pragma once
+#include <deque>
+
 #include "problem.hpp"
 
 /*
  * array of configurations
+ *
+ * Old configurations can be dropped to bound memory, e.g., when they are
+ * already streamed to disk; the plan then keeps a window of timesteps.
+ *
+ * Compact plans store, instead of configurations, a move code of each agent
+ * at each timestep (3 bits, 0: wait, k: k-th neighbor) in blocks, each block
+ * starts from a full configuration (checkpoint). A block is also started
+ * when some move is not to a neighbor. Access to a timestep replays moves
+ * from the checkpoint; sequential access, in the order of timesteps or via
+ * getPath, is amortized O(1) per location. Not thread-safe, even when const.
  */
 
 struct Plan {
 private:
-  Configs configs;  // main
+  Configs configs;  // main, configs[k] is the configuration at offset + k
+  int offset = 0;   // timesteps before offset are dropped
+
+  // compact representation
+  static constexpr int BLOCK_SIZE = 128;  // timesteps per checkpoint
+  static constexpr int CODE_BITS = 3;
+  static constexpr int MAX_CODE = (1 << CODE_BITS) - 1;
+  struct Block {
+    int t0;                      // timestep of checkpoint
+    int len;                     // number of timesteps, including t0
+    Config checkpoint;           // configuration at t0
+    std::vector<uint8_t> codes;  // moves from t0 + s - 1 to t0 + s, packed
+  };
+  bool compact = false;
+  std::deque<Block> blocks;
+  Config tail;                // last configuration
+  mutable Config cursor;      // decoded configuration at cursor_t
+  mutable int cursor_t = -1;  // -1 -> invalid
+
+  int getNumAgents() const;
+  int findBlock(const int t) const;
+  static int getCode(const Block& b, const int s, const int i, const int n);
+  static int getMoveCode(Node* v, Node* u);  // -1 -> not a move
+  void addCompact(const Config& c);
+  const Config& at(const int t) const;  // reference, valid until next call
+
+public:
+  // the first violation of a plan, see findConflict
+  struct Conflict {
+    enum Kind { NONE, EMPTY, DROPPED, SIZE, START, GOAL, MOVE, VERTEX, SWAP };
+    Kind kind = NONE;
+    int t = -1;         // timestep
+    int i = -1;         // agent
+    int j = -1;         // another agent of vertex and swap conflicts
+    Node* v = nullptr;  // location of agent i at t
+    std::string toString() const;
+  };
+
+private:
+  // the first conflict of timesteps [t_begin, t_end), from t_begin - 1
+  Conflict findConflict(const int t_begin, const int t_end) const;
 
 public:
   ~Plan() {}
 
+  // switch representation, only for empty plans
+  void setCompact(const bool _compact);
+  bool isCompact() const { return compact; }
+
   // timestep -> configuration
   Config get(const int t) const;
 
@@ -33,13 +89,19 @@ public:
   // become empty
   void clear();
 
+  // discard configurations before timestep t, the last one is always kept
+  void drop(const int t);
+
+  // first timestep kept in memory
+  int getOffset() const { return offset; }
+
   // add new configuration to the last
   void add(const Config& c);
 
   // whether configs are empty
   bool empty() const;
 
-  // configs.size
+  // number of timesteps, including dropped ones
   int size() const;
 
   // size - 1
@@ -52,11 +114,21 @@ public:
   Plan operator+(const Plan& other) const;
   void operator+=(const Plan& other);
 
-  // check the plan is valid or not
-  bool validate(MAPF_Instance* P) const;
-  bool validate(MAPD_Instance* P) const;
-  bool validate(const Config& starts, const Config& goals) const;
-  bool validate(const Config& starts) const;
+  // check the plan is valid or not, the first conflict is printed
+  bool validate(MAPF_Instance* P, const int num_threads = 1) const;
+  bool validate(MAPD_Instance* P, const int num_threads = 1) const;
+  bool validate(const Config& starts, const Config& goals,
+                const int num_threads = 1) const;
+  bool validate(const Config& starts, const int num_threads = 1) const;
+
+  /*
+   * The first conflict by timestep, then by agent; kind is NONE if valid.
+   * Goals are not checked when empty. Linear time, with occupancy of nodes
+   * at two successive timesteps. Timesteps are split into chunks checked
+   * in parallel when num_threads != 1, except for compact plans.
+   */
+  Conflict findConflict(const Config& starts, const Config& goals = {},
+                        const int num_threads = 1) const;
 
   // when updating a single path,
   // the path should be longer than this value to avoid conflicts
@@ -0,0 +1,31 @@
+/*
+ * order of agents by dynamic priority, e.g., elapsed timesteps in PIBT
+ *
+ * Agents are ordered by keys (the higher the first), then by a static rank
+ * given at initialization. Since keys are small non-negative integers,
+ * the order is updated by counting sort in O(agents + max key)
+ * instead of comparison sort.
+ */
+
+#pragma once
+#include <vector>
+
+class PriorityOrder
+{
+private:
+  std::vector<int> by_rank;  // agent-ids, from the highest static priority
+  std::vector<int> order;    // agent-ids, from the highest priority
+  std::vector<int> counts;   // key -> number of agents, then positions
+
+public:
+  PriorityOrder() {}
+  ~PriorityOrder() {}
+
+  // set agent-ids sorted by static priority, e.g., tie-breakers
+  void init(const std::vector<int>& _by_rank);
+
+  // keys: agent-id -> key, non-negative
+  const std::vector<int>& update(const std::vector<int>& keys);
+
+  const std::vector<int>& get() const { return order; }
+};
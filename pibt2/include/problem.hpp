@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <graph.hpp>
 #include <random>
 
@@ -35,14 +36,14 @@ using Configs = std::vector<Config>;
 class Problem
 {
 protected:
-  std::string instance;  // instance name
-  Graph* G;              // graph
-  std::mt19937* MT;      // seed
-  Config config_s;       // initial configuration
-  Config config_g;       // goal configuration
-  int num_agents;        // number of agents
-  int max_timestep;      // timestep limit
-  int max_comp_time;     // comp_time limit, ms
+  std::string instance;        // instance name
+  Graph* G = nullptr;          // graph
+  std::mt19937* MT = nullptr;  // seed
+  Config config_s;             // initial configuration
+  Config config_g;             // goal configuration
+  int num_agents;              // number of agents
+  int max_timestep;            // timestep limit
+  int max_comp_time;           // comp_time limit, ms
 
   // utilities
   void halt(const std::string& msg) const;
@@ -74,6 +75,7 @@ class MAPF_Instance : public Problem
 {
 private:
   const bool instance_initialized;  // for memory manage
+  bool own_graph = true;            // false -> graph is given by MapLoader
 
   // set starts and goals randomly
   void setRandomStartsGoals();
@@ -82,7 +84,13 @@ private:
   void setWellFormedInstance();
 
 public:
+  // map file -> graph, e.g., to share one graph among instances
+  using MapLoader = std::function<Graph*(const std::string&)>;
+
   MAPF_Instance(const std::string& _instance);
+  // the graph is owned by the loader; seed >= 0 overrides the file's seed
+  MAPF_Instance(const std::string& _instance, const MapLoader& load_map,
+                const int seed = -1);
   MAPF_Instance(MAPF_Instance* P, Config _config_s, Config _config_g,
                 int _max_comp_time, int _max_timestep);
   MAPF_Instance(MAPF_Instance* P, int _max_comp_time);
@@ -123,4 +131,6 @@ public:
   Tasks getOpenTasks() { return TASKS_OPEN; }
   Tasks getClosedTasks() { return TASKS_CLOSED; }
   Nodes getEndpoints() { return LOCS_ENDPOINTS; }
+  Nodes getPickupLocs() { return LOCS_PICKUP; }
+  Nodes getDeliveryLocs() { return LOCS_DELIVERY; }
 };
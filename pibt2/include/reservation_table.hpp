@@ -0,0 +1,84 @@
+/*
+ * time-indexed reservation of locations by agents, used for collision checks
+ *
+ * Occupancy of each timestep is a bitset over nodes; agent ids of reserved
+ * cells, necessary for swap-conflict checks, are kept in a hash map.
+ * Hence memory is O(makespan * V / 64 + reserved cells).
+ * Paths are inserted and removed one by one.
+ * Optionally, agents stay at the last locations of their paths forever,
+ * i.e., parking, without reserving the cells after their paths end.
+ */
+
+#pragma once
+#include <graph.hpp>
+
+#include "search_utils.hpp"
+#include "stats.hpp"
+
+class ReservationTable
+{
+public:
+  static constexpr int NIL = -1;
+
+private:
+  const int words;              // uint64 words per timestep
+  int horizon;                  // bitsets exist for [0, horizon)
+  std::vector<uint64_t> bits;   // timestep * words -> occupancy
+  KeyMap cells;                 // (timestep, node-id) -> agent
+  std::vector<uint64_t> parks;  // node-id -> parked or not
+  KeyMap parked;                // node-id -> agent
+  KeyMap parked_from;           // node-id -> timestep
+  Stats stats;                  // writes
+
+  static uint64_t getKey(const int t, const int v)
+  {
+    return ((uint64_t)t << 32) | (uint32_t)v;
+  }
+
+  static bool test(const uint64_t* row, const int v)
+  {
+    return (row[v >> 6] >> (v & 63)) & 1;
+  }
+
+  bool isParked(const int t, const int v) const
+  {
+    return test(parks.data(), v) && parked_from.get(v, NIL) <= t;
+  }
+
+public:
+  ReservationTable(const int _nodes_size);
+  ~ReservationTable() {}
+
+  // a single cell
+  void reserve(const int t, Node* const v, const int agent);
+  void release(const int t, Node* const v);
+
+  // path[k] is the location at timestep t0 + k
+  void insert(const int agent, const Path& path, const int t0 = 0,
+              const bool park = false);
+  void remove(const Path& path, const int t0 = 0, const bool park = false);
+
+  bool isReserved(const int t, Node* const v) const
+  {
+    if (t < horizon && test(bits.data() + (size_t)t * words, v->id)) {
+      return true;
+    }
+    return isParked(t, v->id);
+  }
+
+  // NIL: not reserved
+  int getAgent(const int t, Node* const v) const
+  {
+    if (t < horizon && test(bits.data() + (size_t)t * words, v->id)) {
+      return cells.get(getKey(t, v->id), NIL);
+    }
+    if (isParked(t, v->id)) return parked.get(v->id, NIL);
+    return NIL;
+  }
+
+  // remove all reservations, memory is kept
+  void clear();
+
+  int getHorizon() const { return horizon; }
+  const Stats& getStats() const { return stats; }
+};
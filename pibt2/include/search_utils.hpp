@@ -0,0 +1,262 @@
+/*
+ * utilities for search, e.g., space-time A*
+ */
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+ * bump allocator
+ * Objects are released at once by clear(); allocated blocks are reused.
+ */
+template <typename T>
+class Arena
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "destructors are never called");
+
+private:
+  static constexpr int BLOCK_SIZE = 4096;  // objects per block
+  using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  std::vector<std::unique_ptr<Storage[]>> blocks;
+  int block_index;  // current block
+  int used;         // used objects in the current block
+
+public:
+  Arena() : block_index(-1), used(BLOCK_SIZE) {}
+  ~Arena() {}
+
+  template <class... Args>
+  T* create(Args&&... args)
+  {
+    if (used == BLOCK_SIZE) {
+      ++block_index;
+      if (block_index == (int)blocks.size()) {
+        blocks.emplace_back(new Storage[BLOCK_SIZE]);
+      }
+      used = 0;
+    }
+    return new (&blocks[block_index][used++]) T(std::forward<Args>(args)...);
+  }
+
+  // release all objects, memory is kept
+  void clear()
+  {
+    block_index = -1;
+    used = BLOCK_SIZE;
+  }
+};
+
+/*
+ * set of 64-bit keys, open addressing with linear probing
+ * Slots are stamped with a generation; clear() just advances it,
+ * hence the set is reused by successive searches without refilling.
+ */
+class KeySet
+{
+private:
+  struct Slot {
+    uint64_t key;
+    uint32_t stamp;  // occupied iff equal to generation
+  };
+
+  std::vector<Slot> slots;
+  uint64_t mask;        // slots.size() - 1, the size is a power of two
+  uint32_t generation;  // current generation, never zero
+  int num;              // number of stored keys
+
+  static uint64_t hash(uint64_t key)
+  {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  void grow();
+
+public:
+  KeySet(const int capacity = 1024);
+  ~KeySet() {}
+
+  // return false if the key already exists
+  bool insert(const uint64_t key)
+  {
+    if (2 * (num + 1) > (int)slots.size()) grow();
+    uint64_t i = hash(key) & mask;
+    while (slots[i].stamp == generation) {
+      if (slots[i].key == key) return false;
+      i = (i + 1) & mask;
+    }
+    slots[i].key = key;
+    slots[i].stamp = generation;
+    ++num;
+    return true;
+  }
+
+  bool contains(const uint64_t key) const
+  {
+    uint64_t i = hash(key) & mask;
+    while (slots[i].stamp == generation) {
+      if (slots[i].key == key) return true;
+      i = (i + 1) & mask;
+    }
+    return false;
+  }
+
+  // O(1) except when the generation wraps around
+  void clear();
+  int size() const { return num; }
+};
+
+/*
+ * map from 64-bit keys to int, open addressing with linear probing
+ * Unlike KeySet, keys can be erased (backward shift deletion).
+ * The maximum key is reserved as empty.
+ */
+class KeyMap
+{
+private:
+  static constexpr uint64_t EMPTY = ~0ULL;
+  struct Slot {
+    uint64_t key;
+    int value;
+  };
+
+  std::vector<Slot> slots;
+  uint64_t mask;  // slots.size() - 1, the size is a power of two
+  int num;        // number of stored keys
+
+  static uint64_t hash(uint64_t key)
+  {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  void grow();
+
+public:
+  KeyMap(const int capacity = 64);
+  ~KeyMap() {}
+
+  // insert or overwrite
+  void set(const uint64_t key, const int value)
+  {
+    if (2 * (num + 1) > (int)slots.size()) grow();
+    uint64_t i = hash(key) & mask;
+    while (slots[i].key != EMPTY) {
+      if (slots[i].key == key) {
+        slots[i].value = value;
+        return;
+      }
+      i = (i + 1) & mask;
+    }
+    slots[i] = Slot{key, value};
+    ++num;
+  }
+
+  // return default_value when not found
+  int get(const uint64_t key, const int default_value) const
+  {
+    uint64_t i = hash(key) & mask;
+    while (slots[i].key != EMPTY) {
+      if (slots[i].key == key) return slots[i].value;
+      i = (i + 1) & mask;
+    }
+    return default_value;
+  }
+
+  void erase(const uint64_t key);
+  void clear();
+  int size() const { return num; }
+};
+
+/*
+ * bucket queue (Dial's algorithm) with two non-negative integer keys
+ * Items are popped in lexicographic order of (primary, secondary),
+ * the lower the first; exact ties are popped in LIFO order.
+ * Push/pop are O(1) amortized when keys are almost monotone,
+ * e.g., f-values of A* with consistent heuristics.
+ * Like KeySet, buckets are stamped and emptied lazily after clear().
+ */
+template <typename T>
+class BucketQueue
+{
+private:
+  struct Bucket {
+    std::vector<std::vector<T>> items;  // secondary key -> items
+    int min_key;                        // lower bound of non-empty keys
+    int num;                            // number of items
+    uint32_t stamp;                     // valid iff equal to generation
+    Bucket() : min_key(0), num(0), stamp(0) {}
+  };
+
+  std::vector<Bucket> buckets;  // primary key -> bucket
+  int min_key;                  // lower bound of non-empty primary keys
+  int num;                      // number of items
+  uint32_t generation;          // current generation, never zero
+
+  bool isEmpty(const Bucket& bucket) const
+  {
+    return bucket.stamp != generation || bucket.num == 0;
+  }
+
+public:
+  BucketQueue() : min_key(0), num(0), generation(1) {}
+  ~BucketQueue() {}
+
+  void push(const T& item, const int primary, const int secondary)
+  {
+    if (primary >= (int)buckets.size()) buckets.resize(primary + 1);
+    auto& bucket = buckets[primary];
+    if (bucket.stamp != generation) {  // used in the previous generations
+      for (auto& items : bucket.items) items.clear();
+      bucket.num = 0;
+      bucket.stamp = generation;
+    }
+    if (secondary >= (int)bucket.items.size()) {
+      bucket.items.resize(secondary + 1);
+    }
+    bucket.items[secondary].push_back(item);
+    if (bucket.num == 0 || secondary < bucket.min_key) {
+      bucket.min_key = secondary;
+    }
+    ++bucket.num;
+    if (num == 0 || primary < min_key) min_key = primary;
+    ++num;
+  }
+
+  // call only when non-empty
+  T pop()
+  {
+    while (isEmpty(buckets[min_key])) ++min_key;
+    auto& bucket = buckets[min_key];
+    while (bucket.items[bucket.min_key].empty()) ++bucket.min_key;
+    auto& items = bucket.items[bucket.min_key];
+    T item = items.back();
+    items.pop_back();
+    --bucket.num;
+    --num;
+    return item;
+  }
+
+  bool empty() const { return num == 0; }
+  int size() const { return num; }
+
+  // remove all items, memory is kept
+  void clear()
+  {
+    if (++generation == 0) {  // wrap around
+      for (auto& bucket : buckets) bucket.stamp = 0;
+      generation = 1;
+    }
+    min_key = 0;
+    num = 0;
+  }
+};
@@ -1,15 +1,24 @@
 #pragma once
 #include <getopt.h>
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <queue>
+#include <sstream>
 #include <unordered_map>
 
+#include "binary_log.hpp"
+#include "distance_table.hpp"
 #include "paths.hpp"
 #include "plan.hpp"
 #include "problem.hpp"
+#include "reservation_table.hpp"
+#include "search_utils.hpp"
+#include "stats.hpp"
 #include "util.hpp"
 
 class MinimumSolver
@@ -28,8 +37,11 @@ private:
   Time::time_point t_start;  // when to start solving
 
 protected:
-  bool verbose;    // true -> print additional info
-  bool log_short;  // true -> cannot visualize the result, default: false
+  bool verbose;     // true -> print additional info
+  bool log_short;   // true -> cannot visualize the result, default: false
+  int num_threads;  // used in parallelized parts, <= 0: all hardware threads
+  bool load_distance_cache;  // true -> use tables stored next to the map
+  bool use_bucket_queue;     // true -> OPEN of A* is a bucket queue
 
   // -------------------------------
   // utilities for time
@@ -52,12 +64,26 @@ protected:
   void halt(const std::string& msg) const;  // halt program
   void warn(const std::string& msg) const;  // just printing msg
 
+  // -------------------------------
+  // instrumentation, see Stats
+protected:
+  Stats stats;  // of this solver, components have their own
+
+public:
+  virtual Stats getStats() const;  // including components
+  void makeStatsFile(const std::string& file = "./stats.json") const;
+
   // -------------------------------
   // utilities for solver options
 public:
   virtual void setParams(int argc, char* argv[]){};
   void setVerbose(bool _verbose) { verbose = _verbose; }
   void setLogShort(bool _log_short) { log_short = _log_short; }
+  void setNumThreads(int _num_threads) { num_threads = _num_threads; }
+  void setLoadDistanceCache(bool _load) { load_distance_cache = _load; }
+  void setBucketQueue(bool _use) { use_bucket_queue = _use; }
+  // effective for solvers that build the solution step by step
+  void setCompactPlan(bool _compact) { solution.setCompact(_compact); }
 
   // -------------------------------
   // print help
@@ -69,19 +95,39 @@ protected:
 
   // space-time A*
   struct AstarNode {
-    Node* v;           // location
-    int g;             // time
-    int f;             // f-value
-    AstarNode* p;      // parent
-    std::string name;  // name
+    Node* v;       // location
+    int g;         // time
+    int f;         // f-value
+    AstarNode* p;  // parent
     AstarNode(Node* _v, int _g, int _f, AstarNode* _p);
-    static std::string getName(Node* _v, int _g);
+    // (node-id, time) packed into 64 bits, used in CLOSE
+    static uint64_t getKey(Node* _v, int _g)
+    {
+      return ((uint64_t)_g << 32) | (uint32_t)_v->id;
+    }
   };
   using CompareAstarNode = std::function<bool(AstarNode*, AstarNode*)>;
   using CheckAstarFin = std::function<bool(AstarNode*)>;
   using CheckInvalidAstarNode = std::function<bool(AstarNode*)>;
   using AstarHeuristics = std::function<int(AstarNode*)>;
   using AstarNodes = std::vector<AstarNode*>;
+  // memory of space-time A*, reused by successive searches
+  struct AstarWorkspace {
+    Arena<AstarNode> GC;              // all generated nodes
+    KeySet CLOSE;                     // CLOSE list
+    AstarNodes heap;                  // OPEN list, binary heap
+    BucketQueue<AstarNode*> buckets;  // OPEN list, bucket queue
+    Stats stats;                      // nodes, over searches
+    // nothing is freed
+    void reset()
+    {
+      GC.clear();
+      CLOSE.clear();
+      heap.clear();
+      buckets.clear();
+    }
+  };
+  AstarWorkspace astar_workspace;  // of this solver, not shared by threads
   /*
    * Template of Space-Time A*.
    * See the following reference.
@@ -89,7 +135,50 @@ protected:
    * Cooperative Pathﬁnding.
    * D. Silver.
    * AI Game Programming Wisdom 3, pages 99–111, 2006.
+   *
+   * Functions are given as policy types, e.g., lambdas,
+   * so that they are inlined into the main loop.
+   * OPEN requires push(AstarNode*), pop() -> AstarNode*, and empty().
+   * The workspace is reset at the beginning, i.e., zero allocation
+   * once its memory has grown enough.
    */
+  template <class Open, class FValue, class CheckFin, class CheckInvalid>
+  static Path getPathBySpaceTimeAstarWithOpen(
+      Node* const s,                         // start
+      AstarWorkspace& W,                     // workspace
+      Open& OPEN,                            // OPEN list on W
+      FValue&& fValue,                       // func: f-value
+      CheckFin&& checkAstarFin,              // func: check goal
+      CheckInvalid&& checkInvalidAstarNode,  // func: check invalid nodes
+      const int time_limit = -1              // time limit
+  );
+  // OPEN is a binary heap, with temporal workspace
+  template <class FValue, class Compare, class CheckFin, class CheckInvalid>
+  static Path getPathBySpaceTimeAstar(
+      Node* const s,                         // start
+      Node* const g,                         // goal
+      FValue&& fValue,                       // func: f-value
+      Compare&& compare,                     // func: compare two nodes
+      CheckFin&& checkAstarFin,              // func: check goal
+      CheckInvalid&& checkInvalidAstarNode,  // func: check invalid nodes
+      const int time_limit = -1              // time limit
+  );
+  // OPEN is a binary heap or a bucket queue, tieKey is used for the latter
+  template <class FValue, class Compare, class TieKey, class CheckFin,
+            class CheckInvalid>
+  static Path getPathBySpaceTimeAstar(
+      Node* const s,                         // start
+      Node* const g,                         // goal
+      AstarWorkspace& W,                     // workspace
+      const bool use_bucket_queue,           // OPEN list type
+      FValue&& fValue,                       // func: f-value
+      Compare&& compare,                     // func: compare two nodes
+      TieKey&& tieKey,                       // func: secondary key of nodes
+      CheckFin&& checkAstarFin,              // func: check goal
+      CheckInvalid&& checkInvalidAstarNode,  // func: check invalid nodes
+      const int time_limit = -1              // time limit
+  );
+  // adapter for std::function
   static Path getPathBySpaceTimeAstar(
       Node* const s,                 // start
       Node* const g,                 // goal
@@ -101,7 +190,76 @@ protected:
       const int time_limit = -1   // time limit
   );
   // typical functions
+  struct CompareAstarNodeBasic {
+    bool operator()(AstarNode* a, AstarNode* b) const
+    {
+      if (a->f != b->f) return a->f > b->f;
+      if (a->g != b->g) return a->g < b->g;
+      return false;
+    }
+  };
   static CompareAstarNode compareAstarNodeBasic;
+  // no tie-breaking other than g-value
+  struct TieKeyAstarNodeBasic {
+    int operator()(AstarNode*) const { return 0; }
+  };
+
+  // OPEN list, binary heap ordered by compare, same as std::priority_queue
+  template <class Compare>
+  class AstarHeap
+  {
+  private:
+    AstarNodes& Q;
+    Compare compare;
+
+  public:
+    AstarHeap(AstarNodes& _Q, const Compare& _compare)
+        : Q(_Q), compare(_compare)
+    {
+    }
+    void push(AstarNode* n)
+    {
+      Q.push_back(n);
+      std::push_heap(Q.begin(), Q.end(), compare);
+    }
+    AstarNode* pop()
+    {
+      std::pop_heap(Q.begin(), Q.end(), compare);
+      AstarNode* n = Q.back();
+      Q.pop_back();
+      return n;
+    }
+    bool empty() const { return Q.empty(); }
+  };
+
+  /*
+   * OPEN list, bucket queue ordered by
+   * f-value -> tie-key (lower first) -> g-value (higher first),
+   * i.e., tie-breaking of compare is expressed as a small tie-key.
+   * Assume f >= g, namely, non-negative heuristics.
+   */
+  template <class TieKey>
+  class AstarBuckets
+  {
+  private:
+    BucketQueue<AstarNode*>& Q;
+    TieKey tieKey;
+
+  public:
+    AstarBuckets(BucketQueue<AstarNode*>& _Q, const TieKey& _tieKey)
+        : Q(_Q), tieKey(_tieKey)
+    {
+    }
+    void push(AstarNode* n)
+    {
+      Q.push(n, n->f, tieKey(n) * (n->f + 1) + (n->f - n->g));
+    }
+    AstarNode* pop() { return Q.pop(); }
+    bool empty() const { return Q.empty(); }
+  };
+
+  // memory-map precomputed distance tables, see DistanceCache
+  void loadDistanceCache(DistanceCache* const cache) const;
 
 public:
   virtual void solve();  // call start -> run -> end
@@ -138,10 +296,11 @@ private:
 
   // distance to goal
 protected:
-  using DistanceTable = std::vector<std::vector<int>>;  // [agent][node_id]
-  DistanceTable distance_table;                         // distance table
-  DistanceTable* distance_table_p;  // pointer, used in nested solvers
-  int preprocessing_comp_time;      // computation time
+  DistanceTables distance_table;     // [agent], distance table
+  DistanceTables* distance_table_p;  // pointer, used in nested solvers
+  std::shared_ptr<DistanceCache> distance_cache;  // goal -> distance table
+  bool lazy_distance_table;     // true -> BFS is expanded on demand
+  int preprocessing_comp_time;  // computation time
 
   // -------------------------------
   // main
@@ -169,9 +328,11 @@ public:
   // log
 public:
   virtual void makeLog(const std::string& logfile = "./result.txt");
+  // compact version, see BinaryLog
+  void makeLogBinary(const std::string& logfile = "./result.bin");
 
 protected:
-  virtual void makeLogBasicInfo(std::ofstream& log);
+  virtual void makeLogBasicInfo(std::ostream& log);
   virtual void makeLogSolution(std::ofstream& log);
 
   // -------------------------------
@@ -194,10 +355,21 @@ public:
                Node* const s) const;  // get path distance between s -> g_i
   int pathDist(const int i) const;    // get path distance between s_i -> g_i
   void createDistanceTable();         // compute distance table
-  void setDistanceTable(DistanceTable* p)
+  void completeDistanceTable();  // finish lazy BFS in parallel, num_threads
+  DistanceTables& getDistanceTables()
+  {
+    return (distance_table_p != nullptr) ? *distance_table_p : distance_table;
+  }
+  void setDistanceTable(DistanceTables* p)
   {
     distance_table_p = p;
   }  // used in nested solvers
+  void setLazyDistanceTable(bool _lazy) { lazy_distance_table = _lazy; }
+  // share tables with other solvers, e.g., when goals repeat across runs
+  void setDistanceCache(std::shared_ptr<DistanceCache> cache)
+  {
+    distance_cache = cache;
+  }
 
   // -------------------------------
   // utilities for getting path
@@ -219,15 +391,24 @@ public:
       const bool manage_path_table =
           true  // manage path table automatically, conflict check
   );
+  // compare and tieKey are given as policy types, e.g., lambda
+  template <class Compare, class TieKey>
+  Path getPrioritizedPath(
+      const int id, const Paths& paths, const int time_limit,
+      const int upper_bound,
+      const std::vector<std::tuple<Node*, int>>& constraints,
+      Compare&& compare, TieKey&& tieKey, const bool manage_path_table);
 
 protected:
-  // used for checking conflicts
+  // used for checking conflicts, agents stay at their goals after arrival
   void updatePathTable(const Paths& paths, const int id);
   void clearPathTable(const Paths& paths);
-  void updatePathTableWithoutClear(const int id, const Path& p,
-                                   const Paths& paths);
-  static constexpr int NIL = -1;
-  std::vector<std::vector<int>> PATH_TABLE;
+  void updatePathTableWithoutClear(const int id, const Path& p);
+  static constexpr int NIL = ReservationTable::NIL;
+  ReservationTable PATH_TABLE;
+
+public:
+  Stats getStats() const;  // including PATH_TABLE
 
 public:
   MAPF_Solver(MAPF_Instance* _P);
@@ -236,6 +417,188 @@ public:
   MAPF_Instance* getP() { return P; }
 };
 
+// -----------------------------------------------
+// template implementations
+// -----------------------------------------------
+template <class Open, class FValue, class CheckFin, class CheckInvalid>
+Path MinimumSolver::getPathBySpaceTimeAstarWithOpen(
+    Node* const s, AstarWorkspace& W, Open& OPEN, FValue&& fValue,
+    CheckFin&& checkAstarFin, CheckInvalid&& checkInvalidAstarNode,
+    const int time_limit)
+{
+  auto t_start = Time::now();
+
+  // nodes of the previous search are released at once
+  W.reset();
+  auto& GC = W.GC;
+  auto& CLOSE = W.CLOSE;
+
+  // initial node
+  AstarNode* n = GC.create(s, 0, 0, nullptr);
+  n->f = fValue(n);
+  OPEN.push(n);
+
+  // generate successor
+  auto expand = [&](Node* u) {
+    int g_cost = n->g + 1;
+    // already searched?
+    if (CLOSE.contains(AstarNode::getKey(u, g_cost))) return;
+    AstarNode* m = GC.create(u, g_cost, 0, n);
+    W.stats.count(Stats::ASTAR_GENERATED);
+    m->f = fValue(m);
+    // check constraints
+    if (checkInvalidAstarNode(m)) return;
+    OPEN.push(m);
+  };
+
+  // main loop
+  bool invalid = true;
+  while (!OPEN.empty()) {
+    // check time limit
+    if (time_limit > 0 && getElapsedTime(t_start) > time_limit) break;
+
+    // minimum node
+    n = OPEN.pop();
+
+    // check CLOSE list
+    if (!CLOSE.insert(AstarNode::getKey(n->v, n->g))) continue;
+
+    // check goal condition
+    if (checkAstarFin(n)) {
+      invalid = false;
+      break;
+    }
+
+    // expand, neighbors then staying
+    W.stats.count(Stats::ASTAR_EXPANDED);
+    for (auto u : n->v->neighbor) expand(u);
+    expand(n->v);
+  }
+
+  Path path;
+  if (!invalid) {  // success
+    while (n != nullptr) {
+      path.push_back(n->v);
+      n = n->p;
+    }
+    std::reverse(path.begin(), path.end());
+  }
+
+  return path;
+}
+
+template <class FValue, class Compare, class CheckFin, class CheckInvalid>
+Path MinimumSolver::getPathBySpaceTimeAstar(
+    Node* const s, Node* const, FValue&& fValue, Compare&& compare,
+    CheckFin&& checkAstarFin, CheckInvalid&& checkInvalidAstarNode,
+    const int time_limit)
+{
+  AstarWorkspace W;
+  AstarHeap<std::decay_t<Compare>> OPEN(W.heap, compare);
+  return getPathBySpaceTimeAstarWithOpen(s, W, OPEN, fValue, checkAstarFin,
+                                         checkInvalidAstarNode, time_limit);
+}
+
+template <class FValue, class Compare, class TieKey, class CheckFin,
+          class CheckInvalid>
+Path MinimumSolver::getPathBySpaceTimeAstar(
+    Node* const s, Node* const, AstarWorkspace& W,
+    const bool use_bucket_queue, FValue&& fValue, Compare&& compare,
+    TieKey&& tieKey, CheckFin&& checkAstarFin,
+    CheckInvalid&& checkInvalidAstarNode, const int time_limit)
+{
+  if (use_bucket_queue) {
+    AstarBuckets<std::decay_t<TieKey>> OPEN(W.buckets, tieKey);
+    return getPathBySpaceTimeAstarWithOpen(s, W, OPEN, fValue, checkAstarFin,
+                                           checkInvalidAstarNode, time_limit);
+  }
+  AstarHeap<std::decay_t<Compare>> OPEN(W.heap, compare);
+  return getPathBySpaceTimeAstarWithOpen(s, W, OPEN, fValue, checkAstarFin,
+                                         checkInvalidAstarNode, time_limit);
+}
+
+template <class Compare, class TieKey>
+Path MAPF_Solver::getPrioritizedPath(
+    const int id, const Paths& paths, const int time_limit,
+    const int upper_bound,
+    const std::vector<std::tuple<Node*, int>>& constraints, Compare&& compare,
+    TieKey&& tieKey, const bool manage_path_table)
+{
+  Node* const s = P->getStart(id);
+  Node* const g = P->getGoal(id);
+  const int ideal_dist = pathDist(id);
+  const int makespan = paths.getMakespan();
+
+  // max timestep that another agent uses the goal
+  int max_constraint_time = 0;
+  for (int t = makespan; t >= ideal_dist; --t) {
+    for (int i = 0; i < P->getNum(); ++i) {
+      if (i != id && !paths.empty(i) && paths.get(i, t) == g) {
+        max_constraint_time = t;
+        break;
+      }
+    }
+    if (max_constraint_time > 0) break;
+  }
+
+  // setup functions
+
+  auto checkAstarFin = [&](AstarNode* n) {
+    return n->v == g && n->g > max_constraint_time;
+  };
+
+  // update PATH_TABLE
+  if (manage_path_table) updatePathTable(paths, id);
+
+  // fast collision checking
+  auto checkInvalidAstarNode = [&](AstarNode* m) {
+    if (upper_bound != -1 && m->g > upper_bound) return true;
+
+    if (makespan > 0) {
+      // vertex conflict, including agents staying at their goals
+      if (PATH_TABLE.isReserved(m->g, m->v)) return true;
+      // swap conflict
+      const int k = PATH_TABLE.getAgent(m->g, m->p->v);
+      if (k != NIL && PATH_TABLE.getAgent(m->g - 1, m->v) == k) return true;
+    }
+
+    // check additional constraints
+    for (auto c : constraints) {
+      const int t = std::get<1>(c);
+      if (m->v == std::get<0>(c) && (t == -1 || t == m->g)) return true;
+    }
+    return false;
+  };
+
+  /*
+   * Note: greedy f-value is indeed a good choice but sacrifice completeness.
+   * > return pathDist(id, n->v)
+   * Since prioritized planning itself returns sub-optimal solutions,
+   * the underlying pathfinding is not limited to optimal sub-solution.
+   * c.f., classical f-value: n->g + pathDist(id, n->v)
+   */
+  Path p;
+  if (ideal_dist > max_constraint_time) {
+    auto fValue = [&](AstarNode* n) { return n->g + pathDist(id, n->v); };
+    p = getPathBySpaceTimeAstar(s, g, astar_workspace, use_bucket_queue,
+                                fValue, compare, tieKey, checkAstarFin,
+                                checkInvalidAstarNode, time_limit);
+  } else {
+    // when someone occupies its goal
+    auto fValue = [&](AstarNode* n) {
+      return std::max(max_constraint_time + 1, n->g + pathDist(id, n->v));
+    };
+    p = getPathBySpaceTimeAstar(s, g, astar_workspace, use_bucket_queue,
+                                fValue, compare, tieKey, checkAstarFin,
+                                checkInvalidAstarNode, time_limit);
+  }
+
+  // clear used path table
+  if (manage_path_table) clearPathTable(paths);
+
+  return p;
+}
+
 // ====================================================
 
 class MAPD_Solver : public MinimumSolver
@@ -243,8 +606,32 @@ class MAPD_Solver : public MinimumSolver
 protected:
   MAPD_Instance* const P;  // problem instance
 
-  std::vector<Nodes> hist_targets;  // time, agent -> current target
-  std::vector<Tasks> hist_tasks;    // time, agent -> assigned_task
+  std::deque<Nodes> hist_targets;  // time - hist_offset, agent -> target
+  std::deque<Tasks> hist_tasks;    // time - hist_offset, agent -> task
+  int hist_offset;                 // timesteps before are dropped
+
+  // append targets and tasks of the next timestep, used by solvers
+  void updateHistory(const Nodes& targets, const Tasks& tasks);
+
+  // -------------------------------
+  // streaming plan
+  // Lines of the solution are written to a spool file in chunks,
+  // then flushed history is dropped from memory except the window.
+private:
+  std::string stream_file;  // spool file, empty -> disabled
+  int stream_chunk;         // timesteps per write
+  bool stream_drop;         // true -> drop flushed timesteps from memory
+  std::ofstream stream;
+  std::ostringstream stream_buffer;  // lines not written yet
+  int streamed;                      // timesteps formatted to lines
+  int streamed_chunk;                // timesteps in stream_buffer
+
+  // format available timesteps, write when the chunk is full or forced
+  void streamPlan(const bool force = false);
+
+public:
+  void setPlanStream(const std::string& _file, const int _chunk,
+                     const bool _drop = true);
 
 public:
   void printResult();
@@ -253,18 +640,21 @@ public:
   // log
 public:
   virtual void makeLog(const std::string& logfile = "./result.txt");
+  // compact version, see BinaryLog
+  void makeLogBinary(const std::string& logfile = "./result.bin");
 
 protected:
-  virtual void makeLogBasicInfo(std::ofstream& log);
+  virtual void makeLogBasicInfo(std::ostream& log);
   virtual void makeLogSolution(std::ofstream& log);
+  // one line of the solution
+  void makeLogTimestep(std::ostream& log, const int t) const;
 
   // -------------------------------
   // distance
 protected:
-  bool use_distance_table;
-  int preprocessing_comp_time;                          // computation time
-  using DistanceTable = std::vector<std::vector<int>>;  // [node_id][node_id]
-  DistanceTable distance_table;                         // distance table
+  bool use_distance_table;      // true -> BFS from endpoints in advance
+  int preprocessing_comp_time;  // computation time
+  std::shared_ptr<DistanceCache> distance_cache;  // goal -> distance table
   int pathDist(Node* const s, Node* const g) const;
 
 private:
@@ -0,0 +1,103 @@
+/*
+ * instrumentation of solvers, per-phase timers and counters
+ *
+ * Enabled at compile time by PIBT2_STATS (cmake -DPIBT2_STATS=ON);
+ * otherwise all operations are empty and removed by the compiler.
+ * Timers are scoped, e.g.,
+ *   auto timer = stats.timer(Stats::PLANNING);
+ * Phases may nest, e.g., streaming logs during the assignment of MAPD.
+ * Counters of PIBT are recorded by the iterative priority inheritance.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+class Stats
+{
+public:
+#ifdef PIBT2_STATS
+  static constexpr bool ENABLED = true;
+#else
+  static constexpr bool ENABLED = false;
+#endif
+
+  enum Phase {
+    DISTANCE_TABLE,  // BFS of distance tables
+    ASSIGNMENT,      // task assignment, MAPD
+    PLANNING,        // next locations or paths
+    ACTING,          // update of agents
+    LOGGING,         // writing results
+    NUM_PHASES
+  };
+
+  enum Counter {
+    INHERITANCES,           // priority inheritance of PIBT
+    MAX_INHERITANCE_DEPTH,  // max, not summed up
+    BACKTRACKS,             // failed inheritance of PIBT
+    ASTAR_EXPANDED,         // nodes of space-time A*
+    ASTAR_GENERATED,        // nodes of space-time A*
+    RESERVATIONS,           // writes to reservation tables
+    NUM_COUNTERS
+  };
+
+  // add elapsed time to the phase when destructed
+  class Timer
+  {
+  private:
+    using Clock = std::chrono::steady_clock;
+    Stats* const stats;
+    const Phase phase;
+    Clock::time_point t_start;
+
+  public:
+    Timer(Stats* _stats, const Phase _phase) : stats(_stats), phase(_phase)
+    {
+      if constexpr (ENABLED) t_start = Clock::now();
+    }
+    ~Timer()
+    {
+      if constexpr (ENABLED) {
+        const auto elapsed = Clock::now() - t_start;
+        stats->times[phase] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count();
+      }
+    }
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+  };
+
+private:
+  uint64_t times[NUM_PHASES] = {};  // nanoseconds
+  uint64_t counts[NUM_COUNTERS] = {};
+
+public:
+  Timer timer(const Phase phase) { return Timer(this, phase); }
+
+  void count(const Counter counter, const uint64_t n = 1)
+  {
+    if constexpr (ENABLED) counts[counter] += n;
+  }
+  void countMax(const Counter counter, const uint64_t n)
+  {
+    if constexpr (ENABLED) {
+      if (counts[counter] < n) counts[counter] = n;
+    }
+  }
+
+  uint64_t getTime(const Phase phase) const { return times[phase]; }
+  uint64_t getCount(const Counter counter) const { return counts[counter]; }
+
+  // e.g., stats of threads or components
+  void merge(const Stats& other);
+
+  static const char* getName(const Phase phase);
+  static const char* getName(const Counter counter);
+
+  // key=value lines, keys are prefixed with "stats_", without logging
+  void writeLog(std::ostream& log) const;
+  // one JSON object
+  void writeJSON(std::ostream& log) const;
+};
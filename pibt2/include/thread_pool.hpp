@@ -0,0 +1,46 @@
+/*
+ * simple thread pool
+ *
+ * With a single thread, tasks are executed by the caller immediately,
+ * i.e., no worker thread is created.
+ */
+
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex mtx;
+  std::condition_variable cv_task;  // notify new tasks or stop
+  std::condition_variable cv_done;  // notify all tasks finished
+  int num_unfinished;               // tasks submitted but not finished
+  bool stop;                        // true -> workers quit
+
+  void work();  // main loop of workers
+
+public:
+  // num_threads <= 0 -> use all hardware threads
+  ThreadPool(int num_threads = 1);
+  ~ThreadPool();
+
+  // add new task
+  void submit(std::function<void()> task);
+
+  // wait until all submitted tasks finish
+  void wait();
+
+  // call f(0), ..., f(n-1) in parallel, then wait
+  void parallelFor(const int n, const std::function<void(int)>& f);
+
+  // number of threads, including the caller when single-threaded
+  int size() const { return std::max(1, (int)workers.size()); }
+};
@@ -19,8 +19,9 @@ private:
   void updatePath2(int i, std::vector<Path>& TOKEN, Tasks& unassigned_tasks);
   void updatePath(int i, Node* g, std::vector<Path>& TOKEN);
 
-  std::vector<std::vector<int>> CONFLICT_TABLE;  // time, node -> agent
-  static constexpr int NIL = -1;
+  ReservationTable CONFLICT_TABLE;   // time, node -> agent
+  std::vector<int> token_endpoints;  // node -> agent, updatePath
+  static constexpr int NIL = ReservationTable::NIL;
 
   // main
   void run();
@@ -29,5 +30,7 @@ public:
   TP(MAPD_Instance* _P, bool _use_distance_table = false);
   ~TP() {}
 
+  Stats getStats() const;  // including CONFLICT_TABLE
+
   static void printHelp();
 };
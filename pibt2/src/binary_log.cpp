@@ -0,0 +1,268 @@
+#include "../include/binary_log.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+constexpr char BinaryLog::MAGIC[];
+
+namespace
+{
+  // -------------------------------
+  // encoding
+  void putVarint(std::string& buf, uint64_t x)
+  {
+    while (x >= 0x80) {
+      buf.push_back((char)(x | 0x80));
+      x >>= 7;
+    }
+    buf.push_back((char)x);
+  }
+
+  uint64_t zigzag(const int64_t x) { return ((uint64_t)x << 1) ^ (x >> 63); }
+
+  int64_t unzigzag(const uint64_t x)
+  {
+    return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);
+  }
+
+  void putString(std::string& buf, const std::string& s)
+  {
+    putVarint(buf, s.size());
+    buf += s;
+  }
+
+  void putPath(std::string& buf, const std::vector<int>& path)
+  {
+    if (path.empty()) return;
+    putVarint(buf, path[0]);
+    for (int t = 1; t < (int)path.size();) {
+      // wait
+      if (path[t] == path[t - 1]) {
+        const int t_from = t;
+        while (t < (int)path.size() && path[t] == path[t - 1]) ++t;
+        putVarint(buf, 0);
+        putVarint(buf, t - t_from);
+        continue;
+      }
+      putVarint(buf, zigzag((int64_t)path[t] - path[t - 1]));
+      ++t;
+    }
+  }
+
+  // values are >= -1, stored as value + 1
+  void putRuns(std::string& buf, const std::vector<int>& values)
+  {
+    for (int t = 0; t < (int)values.size();) {
+      const int t_from = t;
+      while (t < (int)values.size() && values[t] == values[t_from]) ++t;
+      putVarint(buf, values[t_from] + 1);
+      putVarint(buf, t - t_from);
+    }
+  }
+
+  // -------------------------------
+  // decoding, flags invalid data instead of throwing
+  struct Reader {
+    const std::string& buf;
+    size_t pos = 0;
+    bool ok = true;
+
+    Reader(const std::string& _buf) : buf(_buf) {}
+
+    uint64_t varint()
+    {
+      uint64_t x = 0;
+      for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= buf.size()) break;
+        const uint8_t byte = buf[pos++];
+        x |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return x;
+      }
+      ok = false;
+      return 0;
+    }
+
+    int integer()
+    {
+      const uint64_t x = varint();
+      if (x > (uint64_t)INT32_MAX) ok = false;
+      return ok ? (int)x : 0;
+    }
+
+    std::string string()
+    {
+      const uint64_t len = varint();
+      if (!ok || len > buf.size() - pos) {
+        ok = false;
+        return "";
+      }
+      pos += len;
+      return buf.substr(pos - len, len);
+    }
+
+    std::vector<int> path(const int num_timesteps)
+    {
+      std::vector<int> path;
+      if (num_timesteps == 0) return path;
+      path.push_back(integer());
+      while (ok && (int)path.size() < num_timesteps) {
+        const uint64_t token = varint();
+        if (token == 0) {
+          const int run = integer();
+          if (run <= 0 || run > num_timesteps - (int)path.size()) ok = false;
+          if (!ok) break;
+          path.insert(path.end(), run, path.back());
+        } else {
+          const int64_t v = path.back() + unzigzag(token);
+          if (v < 0 || v > INT32_MAX) ok = false;
+          path.push_back(v);
+        }
+      }
+      return path;
+    }
+
+    std::vector<int> runs(const int num_timesteps)
+    {
+      std::vector<int> values;
+      while (ok && (int)values.size() < num_timesteps) {
+        const int value = integer() - 1;
+        const int run = integer();
+        if (run <= 0 || run > num_timesteps - (int)values.size()) ok = false;
+        if (!ok) break;
+        values.insert(values.end(), run, value);
+      }
+      return values;
+    }
+  };
+}  // namespace
+
+bool BinaryLog::write(const std::string& filename) const
+{
+  std::string buf(MAGIC, std::strlen(MAGIC));
+  putVarint(buf, VERSION);
+  putVarint(buf, kind);
+  putString(buf, header);
+  putVarint(buf, has_solution);
+  if (has_solution) {
+    putVarint(buf, width);
+    putVarint(buf, num_agents);
+    putVarint(buf, num_timesteps);
+    for (auto v : starts) putVarint(buf, v);
+    if (kind == MAPF) {
+      for (auto v : goals) putVarint(buf, v);
+    } else {
+      putVarint(buf, tasks.size());
+      for (auto& task : tasks) {
+        putVarint(buf, task.id);
+        putVarint(buf, task.pickup);
+        putVarint(buf, task.delivery);
+        putVarint(buf, task.appear);
+        putVarint(buf, task.finished + 1);
+      }
+    }
+    for (auto& path : paths) putPath(buf, path);
+    if (kind == MAPD) {
+      for (auto& values : targets) putRuns(buf, values);
+      for (auto& values : task_ids) putRuns(buf, values);
+    }
+  }
+
+  std::ofstream file(filename, std::ios::out | std::ios::binary);
+  file.write(buf.data(), buf.size());
+  return (bool)file;
+}
+
+bool BinaryLog::read(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file) return false;
+  const std::string buf((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+  const size_t magic_size = std::strlen(MAGIC);
+  if (buf.compare(0, magic_size, MAGIC) != 0) return false;
+
+  Reader r(buf);
+  r.pos = magic_size;
+  const int version = r.integer();
+  if (!r.ok || version < 1 || version > VERSION) return false;
+  kind = r.integer();
+  if (kind != MAPF && kind != MAPD) return false;
+  header = r.string();
+  has_solution = r.integer();
+  if (!r.ok) return false;
+  if (!has_solution) return true;
+
+  width = r.integer();
+  num_agents = r.integer();
+  num_timesteps = r.integer();
+  if (!r.ok || width <= 0) return false;
+  // each agent needs at least one byte
+  if ((size_t)num_agents > buf.size()) return false;
+
+  starts.resize(num_agents);
+  for (auto& v : starts) v = r.integer();
+  if (kind == MAPF) {
+    goals.resize(num_agents);
+    for (auto& v : goals) v = r.integer();
+  } else {
+    const int num_tasks = r.integer();
+    if (!r.ok || (size_t)num_tasks > buf.size()) return false;
+    tasks.resize(num_tasks);
+    for (auto& task : tasks) {
+      task.id = r.integer();
+      task.pickup = r.integer();
+      task.delivery = r.integer();
+      task.appear = r.integer();
+      task.finished = r.integer() - 1;
+    }
+  }
+  paths.resize(num_agents);
+  for (auto& path : paths) path = r.path(num_timesteps);
+  if (kind == MAPD) {
+    targets.resize(num_agents);
+    for (auto& values : targets) values = r.runs(num_timesteps);
+    task_ids.resize(num_agents);
+    for (auto& values : task_ids) values = r.runs(num_timesteps);
+  }
+  return r.ok && r.pos == buf.size();
+}
+
+void BinaryLog::writeText(std::ostream& os) const
+{
+  auto pos = [&](const int v) {
+    return "(" + std::to_string(v % width) + "," + std::to_string(v / width) +
+           ")";
+  };
+
+  os << header;
+  if (!has_solution) return;
+
+  os << "starts=";
+  for (auto v : starts) os << pos(v) << ",";
+  if (kind == MAPF) {
+    os << "\ngoals=";
+    for (auto v : goals) os << pos(v) << ",";
+    os << "\n";
+  } else {
+    os << "\n";
+    os << "task=\n";
+    for (auto& task : tasks) {
+      os << task.id << ":" << task.pickup << "->" << task.delivery << ","
+         << "appear=" << task.appear << ","
+         << "finished=" << task.finished << "\n";
+    }
+  }
+  os << "solution=\n";
+  for (int t = 0; t < num_timesteps; ++t) {
+    os << t << ":";
+    for (int i = 0; i < num_agents; ++i) {
+      os << pos(paths[i][t]);
+      if (kind == MAPD) {
+        os << "->" << pos(targets[i][t]) << ":" << task_ids[i][t];
+      }
+      os << ",";
+    }
+    os << "\n";
+  }
+}
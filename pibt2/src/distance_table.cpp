@@ -0,0 +1,287 @@
+#include "../include/distance_table.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "../include/thread_pool.hpp"
+
+DistanceTable::DistanceTable(Graph* _G, Node* _g, const int _max_dist)
+    : G(_G),
+      g(_g),
+      max_dist(_max_dist),
+      head(0)
+{
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const int nodes_size = G->getNodesSize();
+  const size_t bytes =
+      ((nodes_size * sizeof(Dist) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  storage.reset(static_cast<Dist*>(std::aligned_alloc(ALIGNMENT, bytes)));
+  table = storage.get();
+  std::fill(table, table + nodes_size, NIL);
+  table[g->id] = 0;
+  OPEN.push_back(g);
+}
+
+DistanceTable::DistanceTable(Graph* _G, Node* _g, const int _max_dist,
+                             const Dist* _table,
+                             std::shared_ptr<const void> _mapping)
+    : G(_G),
+      g(_g),
+      max_dist(_max_dist),
+      // never written since the table is completed
+      table(const_cast<Dist*>(_table)),
+      mapping(_mapping),
+      head(0)
+{
+}
+
+void DistanceTable::expand()
+{
+  Node* n = OPEN[head++];
+  const int d_m = table[n->id] + 1;
+  // same as the eager version, nodes farther than max_dist are not settled
+  if (d_m >= max_dist || d_m >= NIL) return;
+  for (auto m : n->neighbor) {
+    if (table[m->id] != NIL) continue;
+    table[m->id] = d_m;
+    OPEN.push_back(m);
+  }
+}
+
+void DistanceTable::initMoves()
+{
+  std::call_once(moves_allocated, [&] {
+    const int nodes_size = G->getNodesSize();
+    moves.reset(new std::atomic<uint8_t>[nodes_size]);
+    for (int i = 0; i < nodes_size; ++i) {
+      moves[i].store(MOVES_NIL, std::memory_order_relaxed);
+    }
+  });
+}
+
+uint8_t DistanceTable::computeMoves(Node* const v)
+{
+  const int d_v = get(v);
+  const int degree = std::min(v->getDegree(), MAX_MOVES);
+  uint8_t keys = 0;
+  for (int k = 0; k < degree; ++k) {
+    // adjacent nodes differ in distance by at most one
+    keys |= (get(v->neighbor[k]) - d_v + 1) << (2 * k);
+  }
+  return keys;
+}
+
+void DistanceTable::complete()
+{
+  // already completed and released, no writes for shared tables
+  if (OPEN.empty()) return;
+  while (!completed()) expand();
+  // queue is no longer necessary
+  OPEN.clear();
+  OPEN.shrink_to_fit();
+  head = 0;
+}
+
+DistanceCache::DistanceCache(Graph* _G, const int _max_dist)
+    : G(_G), max_dist(_max_dist), tables(G->getNodesSize(), nullptr)
+{
+}
+
+void DistanceCache::create(Node* const g)
+{
+  tables[g->id] = std::make_shared<DistanceTable>(G, g, max_dist);
+}
+
+std::shared_ptr<DistanceTable> DistanceCache::get(Node* const g)
+{
+  if (tables[g->id] == nullptr) create(g);
+  return tables[g->id];
+}
+
+void DistanceCache::complete(const Nodes& goals, const int num_threads)
+{
+  // creation is sequential, BFS of distinct goals are independent
+  DistanceTables targets;
+  std::vector<bool> added(G->getNodesSize(), false);
+  for (auto g : goals) {
+    if (added[g->id]) continue;
+    added[g->id] = true;
+    if (tables[g->id] == nullptr) create(g);
+    if (!tables[g->id]->completed()) targets.push_back(tables[g->id]);
+  }
+  ThreadPool pool(num_threads);
+  pool.parallelFor(targets.size(), [&](int k) { targets[k]->complete(); });
+}
+
+void DistanceCache::release()
+{
+  for (auto& table : tables) {
+    if (table != nullptr && table.use_count() == 1) table.reset();
+  }
+}
+
+int DistanceCache::size() const
+{
+  return std::count_if(tables.begin(), tables.end(),
+                       [](auto& table) { return table != nullptr; });
+}
+
+// -------------------------------
+// persistent cache
+// -------------------------------
+namespace
+{
+  // file layout:
+  //   header (64 bytes), goal ids (int32, padded to 64 bytes),
+  //   rows of distances (uint16, each padded to 64 bytes)
+  struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodes_size;
+    uint64_t hash;
+    uint32_t max_dist;
+    uint32_t num_goals;
+    char padding[32];
+  };
+  static_assert(sizeof(CacheHeader) == DistanceTable::ALIGNMENT);
+  const char CACHE_MAGIC[8] = "PIBT2DT";
+  constexpr uint32_t CACHE_VERSION = 1;
+
+  size_t alignUp(const size_t bytes)
+  {
+    const size_t a = DistanceTable::ALIGNMENT;
+    return ((bytes + a - 1) / a) * a;
+  }
+
+  // FNV-1a, content of the file; nothing when not found
+  void hashFile(const std::string& filename, uint64_t& hash)
+  {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return;
+    char c;
+    while (file.get(c)) {
+      hash ^= (unsigned char)c;
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  // empty for graphs other than grids, i.e., no persistent cache
+  std::string getMapPath(Graph* const G)
+  {
+    auto grid = dynamic_cast<Grid*>(G);
+    if (grid == nullptr) return "";
+#ifdef _MAPDIR_
+    return _MAPDIR_ + grid->getMapFileName();
+#else
+    return grid->getMapFileName();
+#endif
+  }
+
+  uint64_t getMapHash(Graph* const G)
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    const std::string map_path = getMapPath(G);
+    hashFile(map_path, hash);
+    hashFile(map_path + ".pd", hash);
+    return hash;
+  }
+
+  // unmap when the last table is removed
+  struct Mapping {
+    void* addr;
+    size_t length;
+    ~Mapping() { munmap(addr, length); }
+  };
+}  // namespace
+
+std::string DistanceCache::getCacheFileName(Graph* const G)
+{
+  if (getMapPath(G).empty()) return "";
+  std::stringstream ss;
+  ss << getMapPath(G) << "." << std::hex << std::setw(16) << std::setfill('0')
+     << getMapHash(G) << ".dist";
+  return ss.str();
+}
+
+void DistanceCache::save(const std::string& filename) const
+{
+  Nodes goals;
+  for (auto& table : tables) {
+    if (table == nullptr || !table->completed()) continue;
+    goals.push_back(table->getGoal());
+  }
+
+  CacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+  header.version = CACHE_VERSION;
+  header.nodes_size = G->getNodesSize();
+  header.hash = getMapHash(G);
+  header.max_dist = max_dist;
+  header.num_goals = goals.size();
+
+  std::ofstream file(filename, std::ios::binary);
+  const std::vector<char> zeros(DistanceTable::ALIGNMENT, 0);
+  auto pad = [&](const size_t bytes) {
+    file.write(zeros.data(), alignUp(bytes) - bytes);
+  };
+  file.write(reinterpret_cast<char*>(&header), sizeof(header));
+  for (auto g : goals) {
+    const int32_t id = g->id;
+    file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+  }
+  pad(goals.size() * sizeof(int32_t));
+  const size_t row_bytes = header.nodes_size * sizeof(DistanceTable::Dist);
+  for (auto g : goals) {
+    file.write(reinterpret_cast<const char*>(tables[g->id]->data()),
+               row_bytes);
+    pad(row_bytes);
+  }
+}
+
+bool DistanceCache::load(const std::string& filename)
+{
+  FILE* fp = std::fopen(filename.c_str(), "rb");
+  if (fp == nullptr) return false;
+  std::fseek(fp, 0, SEEK_END);
+  const size_t length = std::ftell(fp);
+  void* addr = nullptr;
+  if (length >= sizeof(CacheHeader)) {
+    addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+  }
+  std::fclose(fp);
+  if (addr == nullptr || addr == MAP_FAILED) return false;
+  std::shared_ptr<Mapping> mapping(new Mapping{addr, length});
+
+  // check consistency, e.g., stale cache or capped distances
+  const auto header = static_cast<const CacheHeader*>(addr);
+  const size_t row_bytes =
+      alignUp(header->nodes_size * sizeof(DistanceTable::Dist));
+  const size_t goals_bytes = alignUp(header->num_goals * sizeof(int32_t));
+  if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+      header->version != CACHE_VERSION ||
+      (int)header->nodes_size != G->getNodesSize() ||
+      header->hash != getMapHash(G) || (int)header->max_dist < max_dist ||
+      length < sizeof(CacheHeader) + goals_bytes +
+                   header->num_goals * row_bytes) {
+    return false;
+  }
+
+  const char* base = static_cast<const char*>(addr);
+  auto ids = reinterpret_cast<const int32_t*>(base + sizeof(CacheHeader));
+  const char* rows = base + sizeof(CacheHeader) + goals_bytes;
+  for (int k = 0; k < (int)header->num_goals; ++k) {
+    Node* g = G->getNode(ids[k]);
+    if (g == nullptr || tables[g->id] != nullptr) continue;
+    tables[g->id] = std::make_shared<DistanceTable>(
+        G, g, max_dist,
+        reinterpret_cast<const DistanceTable::Dist*>(rows + k * row_bytes),
+        mapping);
+  }
+  return true;
+}
@@ -12,6 +12,7 @@ HCA::HCA(MAPF_Instance* _P)
 
 void HCA::run()
 {
+  auto timer = stats.timer(Stats::PLANNING);
   Paths paths(P->getNum());
 
   // create tables for tie-break
@@ -66,10 +67,7 @@ Path HCA::getPrioritizedPath(int id, const Paths& paths)
   Node* s = P->getStart(id);
   Node* g = P->getGoal(id);
 
-  Nodes config_s = P->getConfigStart();
-  Nodes config_g = P->getConfigGoal();
-
-  CompareAstarNode compare = [&](AstarNode* a, AstarNode* b) {
+  auto compare = [&](AstarNode* a, AstarNode* b) {
     if (a->f != b->f) return a->f > b->f;
     // tie-break, avoid goal locations of others
     if (a->v != g && table_goals[a->v->id]) return true;
@@ -81,11 +79,17 @@ Path HCA::getPrioritizedPath(int id, const Paths& paths)
     return false;
   };
 
+  // the same tie-breaking for bucket queue, lower first
+  auto tieKey = [&](AstarNode* n) {
+    return 2 * (n->v != g && table_goals[n->v->id]) +
+           (n->v != s && table_starts[n->v->id]);
+  };
+
   const auto p = MAPF_Solver::getPrioritizedPath(
-      id, paths, getRemainedTime(), max_timestep, {}, compare, false);
+      id, paths, getRemainedTime(), max_timestep, {}, compare, tieKey, false);
 
   // update path table
-  updatePathTableWithoutClear(id, p, paths);
+  updatePathTableWithoutClear(id, p);
 
   return p;
 }
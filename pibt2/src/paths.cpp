@@ -1,5 +1,8 @@
 #include "../include/paths.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 Paths::Paths(int num_agents)
 {
   std::vector<Path> tmp(num_agents, Path(0));
@@ -7,7 +10,7 @@ Paths::Paths(int num_agents)
   makespan = 0;
 }
 
-Path Paths::get(int i) const
+const Path& Paths::get(int i) const
 {
   const int paths_size = paths.size();
   if (!(0 <= i && i < paths_size)) halt("invalid index");
@@ -42,13 +45,27 @@ void Paths::insert(int i, const Path& path)
   const int old_len = paths[i].size();
   paths[i] = path;
   const int path_size = path.size();
-  if (path_size - 1 == getMakespan()) return;
+  if (path_size - 1 == getMakespan()) {
+    // the layout of ids is unchanged
+    if (ids_valid) {
+      for (int t = 0; t < path_size; ++t) {
+        ids[t * paths_size + i] = path[t]->id;
+        if (path[t]->id > max_id) max_id = path[t]->id;
+      }
+    }
+    return;
+  }
+  ids_valid = false;
   format();                           // align each path size
   if (path_size < old_len) shrink();  // cutoff additional configs
   makespan = getMaxLengthPaths();     // update makespan
 }
 
-void Paths::clear(int i) { paths[i].clear(); }
+void Paths::clear(int i)
+{
+  paths[i].clear();
+  ids_valid = false;
+}
 
 int Paths::size() const { return paths.size(); }
 
@@ -113,6 +130,7 @@ int Paths::getSOC() const
 
 void Paths::format()
 {
+  ids_valid = false;
   const int paths_size = paths.size();
   int len = getMaxLengthPaths();
   for (int i = 0; i < paths_size; ++i) {
@@ -127,6 +145,7 @@ void Paths::format()
 
 void Paths::shrink()
 {
+  ids_valid = false;
   const int paths_size = paths.size();
   while (true) {
     bool shrinkable = true;
@@ -154,59 +173,121 @@ bool Paths::conflicted(int i, int j, int t) const
   return false;
 }
 
-int Paths::countConflict() const
+void Paths::buildIds() const
 {
-  int cnt = 0;
-  int num_agents = size();
-  int makespan = getMakespan();
+  if (ids_valid) return;
+  const int num_agents = size();
+  ids.assign((size_t)(makespan + 1) * num_agents, -1);
+  max_id = -1;
   for (int i = 0; i < num_agents; ++i) {
-    for (int j = i + 1; j < num_agents; ++j) {
-      for (int t = 1; t <= makespan; ++t) {
-        if (conflicted(i, j, t)) ++cnt;
-      }
+    if (paths[i].empty()) continue;
+    for (int t = 0; t <= makespan; ++t) {
+      const int v = paths[i][t]->id;
+      ids[t * num_agents + i] = v;
+      if (v > max_id) max_id = v;
     }
   }
-  return cnt;
+  ids_valid = true;
+}
+
+int Paths::countConflict() const
+{
+  std::vector<int> sample(size());
+  std::iota(sample.begin(), sample.end(), 0);
+  return countConflict(sample);
 }
 
 int Paths::countConflict(const std::vector<int>& sample) const
 {
-  int cnt = 0;
-  int makespan = getMakespan();
+  // equivalent to conflicted() for all pairs of the sample, i.e.,
+  // at most one conflict per pair and timestep
+  buildIds();
+  const int num_agents = size();
   const int sample_size = sample.size();
-  for (int i = 0; i < sample_size; ++i) {
-    for (int j = i + 1; j < sample_size; ++j) {
-      for (int t = 1; t <= makespan; ++t) {
-        if (conflicted(sample[i], sample[j], t)) ++cnt;
+  for (auto i : sample) {
+    if (!(0 <= i && i < num_agents)) halt("invalid index");
+  }
+  // occupancy at t: number of agents for each node
+  std::vector<int> occupancy(max_id + 1, 0);
+  // occupancy at t-1: agents for each node as linked lists of indexes
+  std::vector<int> head(max_id + 1, -1);
+  std::vector<int> next(sample_size, -1);
+
+  int cnt = 0;
+  for (int t = 1; t <= makespan; ++t) {
+    const int* ids_prev = &ids[(t - 1) * num_agents];
+    const int* ids_now = &ids[t * num_agents];
+    for (int k = 0; k < sample_size; ++k) {
+      const int u = ids_prev[sample[k]];
+      if (u < 0) continue;
+      next[k] = head[u];
+      head[u] = k;
+    }
+
+    for (int k = 0; k < sample_size; ++k) {
+      const int u = ids_prev[sample[k]];
+      const int v = ids_now[sample[k]];
+      if (v < 0) continue;
+      // vertex conflicts with agents already at v
+      cnt += occupancy[v]++;
+      // swap conflicts, counted once by the latter index
+      if (u == v) continue;
+      for (int l = head[v]; l != -1; l = next[l]) {
+        if (l > k && ids_now[sample[l]] == u) ++cnt;
       }
     }
+
+    // reset tables
+    for (int k = 0; k < sample_size; ++k) {
+      const int u = ids_prev[sample[k]];
+      const int v = ids_now[sample[k]];
+      if (u >= 0) head[u] = -1;
+      if (v >= 0) occupancy[v] = 0;
+    }
   }
   return cnt;
 }
 
 int Paths::countConflict(int id, const Path& path) const
 {
-  int cnt = 0;
-  int makespan = getMakespan();
-  int num_agents = size();
+  buildIds();
+  const int num_agents = size();
   const int path_size = path.size();
-  for (int i = 0; i < num_agents; ++i) {
-    if (i == id) continue;
-    for (int t = 1; t < path_size; ++t) {
-      if (t > makespan) {
-        if (path[t] == get(i, makespan)) {
-          ++cnt;
-          break;
-        }
-        continue;
-      }
-      // vertex conflict
-      if (get(i, t) == path[t]) {
-        ++cnt;
-        continue;
+  const int t_max = std::min(path_size - 1, makespan);
+
+  // compare ids of all agents at each timestep, then exclude agent-id
+  auto at = [&](const int* ids_t, const int i) {
+    return (0 <= i && i < num_agents) ? ids_t[i] : -1;
+  };
+  int cnt = 0;
+  for (int t = 1; t <= t_max; ++t) {
+    const int* ids_prev = &ids[(t - 1) * num_agents];
+    const int* ids_now = &ids[t * num_agents];
+    const int v = path[t]->id;
+    const int u = path[t - 1]->id;
+    // vertex conflicts
+    int c = 0;
+    for (int i = 0; i < num_agents; ++i) c += (ids_now[i] == v);
+    // swap conflicts, exclusive to vertex ones when u != v
+    if (u != v) {
+      for (int i = 0; i < num_agents; ++i) {
+        c += (ids_now[i] == u) & (ids_prev[i] == v);
       }
-      // swap conflict
-      if (get(i, t) == path[t - 1] && get(i, t - 1) == path[t]) ++cnt;
+      c -= (at(ids_now, id) == u) & (at(ids_prev, id) == v);
+    }
+    c -= (at(ids_now, id) == v);
+    cnt += c;
+  }
+
+  // after makespan, each agent conflicts at most once at its last node
+  if (path_size - 1 > makespan) {
+    std::vector<bool> visited(max_id + 1, false);
+    for (int t = makespan + 1; t < path_size; ++t) {
+      if (path[t]->id <= max_id) visited[path[t]->id] = true;
+    }
+    const int* ids_last = &ids[makespan * num_agents];
+    for (int i = 0; i < num_agents; ++i) {
+      if (i != id && ids_last[i] >= 0 && visited[ids_last[i]]) ++cnt;
     }
   }
   return cnt;
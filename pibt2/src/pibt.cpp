@@ -1,75 +1,117 @@
 #include "../include/pibt.hpp"
 
+#include <atomic>
+
 const std::string PIBT::SOLVER_NAME = "PIBT";
 
 PIBT::PIBT(MAPF_Instance* _P)
     : MAPF_Solver(_P),
-      occupied_now(Agents(G->getNodesSize(), nullptr)),
-      occupied_next(Agents(G->getNodesSize(), nullptr))
+      occupied_now(G->getNodesSize(), NIL),
+      occupied_next(G->getNodesSize(), NIL)
 {
   solver_name = PIBT::SOLVER_NAME;
 }
 
 void PIBT::run()
 {
-  // compare priority of agents
-  auto compare = [](Agent* a, const Agent* b) {
-    if (a->elapsed != b->elapsed) return a->elapsed > b->elapsed;
-    // use initial distance
-    if (a->init_d != b->init_d) return a->init_d > b->init_d;
-    return a->tie_breaker > b->tie_breaker;
-  };
-  Agents A;
+  // candidates are stored in fixed-size buffers
+  for (auto v : G->getV()) {
+    if (v != nullptr && (int)v->neighbor.size() + 1 > MAX_CANDIDATES) {
+      halt("too many neighbors, PIBT assumes four-connected grids");
+    }
+  }
 
   // initialize
-  for (int i = 0; i < P->getNum(); ++i) {
-    Node* s = P->getStart(i);
-    Node* g = P->getGoal(i);
-    int d = disable_dist_init ? 0 : pathDist(i);
-    Agent* a = new Agent{i,                          // id
-                         s,                          // current location
-                         nullptr,                    // next location
-                         g,                          // goal
-                         0,                          // elapsed
-                         d,                          // dist from s -> g
-                         getRandomFloat(0, 1, MT)};  // tie-breaker
-    A.push_back(a);
-    occupied_now[s->id] = a;
+  const int num_agents = P->getNum();
+  v_now.resize(num_agents);
+  v_next.assign(num_agents, nullptr);
+  goals.resize(num_agents);
+  elapsed.assign(num_agents, 0);
+  init_d.resize(num_agents);
+  tie_breakers.resize(num_agents);
+  stack.reserve(num_agents);
+  if (use_move_table) {
+    // keys are computed lazily, only for visited nodes
+    auto timer = stats.timer(Stats::DISTANCE_TABLE);
+    move_tables.resize(num_agents);
+    auto& tables = getDistanceTables();
+    for (int i = 0; i < num_agents; ++i) {
+      tables[i]->initMoves();
+      move_tables[i] = tables[i].get();
+    }
+  }
+  ThreadPool pool(parallel ? num_threads : 1);
+  std::vector<Stack> stacks(pool.size());
+  std::vector<Stats> worker_stats(pool.size());
+  if (parallel) {
+    // distance tables are read concurrently
+    auto timer = stats.timer(Stats::DISTANCE_TABLE);
+    completeDistanceTable();
+    uf_parent.resize(num_agents);
+    claimed.assign(G->getNodesSize(), NIL);
+    cluster_id.assign(num_agents, NIL);
+    cluster_head.reserve(num_agents + 1);
+    members.resize(num_agents);
+    for (auto& s : stacks) s.reserve(num_agents);
+  }
+  for (int i = 0; i < num_agents; ++i) {
+    v_now[i] = P->getStart(i);
+    goals[i] = P->getGoal(i);
+    init_d[i] = disable_dist_init ? 0 : pathDist(i);
+    tie_breakers[i] = getRandomFloat(0, 1, MT);
+    occupied_now[v_now[i]->id] = i;
   }
   solution.add(P->getConfigStart());
 
-  // main loop
+  // static part of priority: initial distance, then tie-breaker
+  std::vector<int> by_rank(num_agents);
+  std::iota(by_rank.begin(), by_rank.end(), 0);
+  std::stable_sort(by_rank.begin(), by_rank.end(), [&](int a, int b) {
+    if (init_d[a] != init_d[b]) return init_d[a] > init_d[b];
+    return tie_breakers[a] > tie_breakers[b];
+  });
+  order.init(by_rank);
+
+  // main loop, no allocation except for the plan
+  Config config(num_agents, nullptr);
   int timestep = 0;
   while (true) {
     info(" ", "elapsed:", getSolverElapsedTime(), ", timestep:", timestep);
 
-    // planning
-    std::sort(A.begin(), A.end(), compare);
-    for (auto a : A) {
-      // if the agent has next location, then skip
-      if (a->v_next == nullptr) {
-        // determine its next location
-        funcPIBT(a);
+    // planning, higher elapsed first
+    if (parallel) {
+      auto timer = stats.timer(Stats::PLANNING);
+      planInParallel(order.update(elapsed), pool, stacks, worker_stats);
+    } else {
+      auto timer = stats.timer(Stats::PLANNING);
+      for (auto i : order.update(elapsed)) {
+        // if the agent has next location, then skip
+        if (v_next[i] == nullptr) {
+          // determine its next location
+          funcPIBT(i);
+        }
       }
     }
 
-    // acting
+    // acting, the result does not depend on the order of agents
     bool check_goal_cond = true;
-    Config config(P->getNum(), nullptr);
-    for (auto a : A) {
-      // clear
-      if (occupied_now[a->v_now->id] == a) occupied_now[a->v_now->id] = nullptr;
-      occupied_next[a->v_next->id] = nullptr;
-      // set next location
-      config[a->id] = a->v_next;
-      occupied_now[a->v_next->id] = a;
-      // check goal condition
-      check_goal_cond &= (a->v_next == a->g);
-      // update priority
-      a->elapsed = (a->v_next == a->g) ? 0 : a->elapsed + 1;
-      // reset params
-      a->v_now = a->v_next;
-      a->v_next = nullptr;
+    {
+      auto timer = stats.timer(Stats::ACTING);
+      for (int i = 0; i < num_agents; ++i) {
+        // clear
+        if (occupied_now[v_now[i]->id] == i) occupied_now[v_now[i]->id] = NIL;
+        occupied_next[v_next[i]->id] = NIL;
+        // set next location
+        config[i] = v_next[i];
+        occupied_now[v_next[i]->id] = i;
+        // check goal condition
+        check_goal_cond &= (v_next[i] == goals[i]);
+        // update priority
+        elapsed[i] = (v_next[i] == goals[i]) ? 0 : elapsed[i] + 1;
+        // reset params
+        v_now[i] = v_next[i];
+        v_next[i] = nullptr;
+      }
     }
 
     // update plan
@@ -89,53 +131,254 @@ void PIBT::run()
     }
   }
 
-  // memory clear
-  for (auto a : A) delete a;
+  for (auto& s : worker_stats) stats.merge(s);
+}
+
+int PIBT::findCluster(int i)
+{
+  while (uf_parent[i] != i) {
+    uf_parent[i] = uf_parent[uf_parent[i]];  // path halving
+    i = uf_parent[i];
+  }
+  return i;
+}
+
+void PIBT::uniteCluster(const int i, const int j)
+{
+  const int r_i = findCluster(i);
+  const int r_j = findCluster(j);
+  if (r_i == r_j) return;
+  // smaller id becomes the root, independent of the order of calls
+  if (r_i < r_j) {
+    uf_parent[r_j] = r_i;
+  } else {
+    uf_parent[r_i] = r_j;
+  }
+}
+
+int PIBT::makeClusters(const std::vector<int>& sorted)
+{
+  const int num_agents = P->getNum();
+
+  // unite agents sharing candidates
+  std::iota(uf_parent.begin(), uf_parent.end(), 0);
+  auto claim = [&](const int i, Node* const u) {
+    if (claimed[u->id] == NIL) {
+      claimed[u->id] = i;
+    } else {
+      uniteCluster(i, claimed[u->id]);
+    }
+  };
+  for (int i = 0; i < num_agents; ++i) {
+    claim(i, v_now[i]);
+    for (auto u : v_now[i]->neighbor) claim(i, u);
+  }
+  for (int i = 0; i < num_agents; ++i) {
+    claimed[v_now[i]->id] = NIL;
+    for (auto u : v_now[i]->neighbor) claimed[u->id] = NIL;
+  }
+
+  // clusters ordered by their first agents, counting sort by cluster
+  int num_clusters = 0;
+  cluster_head.clear();
+  for (auto i : sorted) {
+    const int r = findCluster(i);
+    if (cluster_id[r] == NIL) {
+      cluster_id[r] = num_clusters++;
+      cluster_head.push_back(0);
+    }
+    ++cluster_head[cluster_id[r]];
+  }
+  cluster_head.push_back(0);
+  for (int c = 0, offset = 0; c <= num_clusters; ++c) {
+    const int cnt = cluster_head[c];
+    cluster_head[c] = offset;
+    offset += cnt;
+  }
+  for (auto i : sorted) {
+    const int c = cluster_id[findCluster(i)];
+    members[cluster_head[c]++] = i;
+  }
+  // restore heads, shifted by the filling above
+  for (int c = num_clusters; c > 0; --c) cluster_head[c] = cluster_head[c - 1];
+  cluster_head[0] = 0;
+  for (auto i : sorted) cluster_id[i] = NIL;
+
+  return num_clusters;
+}
+
+void PIBT::planInParallel(const std::vector<int>& sorted, ThreadPool& pool,
+                          std::vector<Stack>& stacks,
+                          std::vector<Stats>& worker_stats)
+{
+  const int num_clusters = makeClusters(sorted);
+  const uint32_t seed = (*MT)();  // one draw per timestep
+
+  std::atomic<int> next(0);
+  pool.parallelFor(stacks.size(), [&](int w) {
+    ClusterRNG rng;
+    for (int c = next++; c < num_clusters; c = next++) {
+      // the first agent identifies the cluster
+      rng.seed(seed ^ ((uint32_t)members[cluster_head[c]] * 0x9e3779b9U));
+      for (int k = cluster_head[c]; k < cluster_head[c + 1]; ++k) {
+        const int i = members[k];
+        if (v_next[i] == nullptr) {
+          funcPIBTIterative(i, stacks[w], rng, worker_stats[w]);
+        }
+      }
+    }
+  });
 }
 
-bool PIBT::funcPIBT(Agent* ai, Agent* aj)
+template <typename RNG>
+int PIBT::getCandidates(const int i, Node** C, RNG& rng)
 {
+  // candidate with its distance to the goal, or the key of the move
+  struct Candidate {
+    Node* v;
+    int d;
+  };
+  Candidate D[MAX_CANDIDATES];
+
   // compare two nodes
-  auto compare = [&](Node* const v, Node* const u) {
-    int d_v = pathDist(ai->id, v);
-    int d_u = pathDist(ai->id, u);
-    if (d_v != d_u) return d_v < d_u;
+  auto compare = [&](const Candidate& a, const Candidate& b) {
+    if (a.d != b.d) return a.d < b.d;
     // tie break
-    if (occupied_now[v->id] != nullptr && occupied_now[u->id] == nullptr)
-      return false;
-    if (occupied_now[v->id] == nullptr && occupied_now[u->id] != nullptr)
-      return true;
+    Node* const v = a.v;
+    Node* const u = b.v;
+    if (occupied_now[v->id] != NIL && occupied_now[u->id] == NIL) return false;
+    if (occupied_now[v->id] == NIL && occupied_now[u->id] != NIL) return true;
     return false;
   };
 
-  // get candidates
-  Nodes C = ai->v_now->neighbor;
-  C.push_back(ai->v_now);
+  Node* const v = v_now[i];
+  int num_candidates = 0;
+  if (use_move_table) {
+    // keys are distances relative to the current location
+    const uint8_t keys = move_tables[i]->getMoves(v);
+    for (auto u : v->neighbor) {
+      D[num_candidates] = {u, DistanceTable::getMoveKey(keys, num_candidates)};
+      ++num_candidates;
+    }
+    D[num_candidates++] = {v, 1};
+  } else {
+    for (auto u : v->neighbor) D[num_candidates++] = {u, pathDist(i, u)};
+    D[num_candidates++] = {v, pathDist(i, v)};
+  }
   // randomize
-  std::shuffle(C.begin(), C.end(), *MT);
+  std::shuffle(D, D + num_candidates, rng);
   // sort
-  std::sort(C.begin(), C.end(), compare);
+  std::sort(D, D + num_candidates, compare);
+  for (int k = 0; k < num_candidates; ++k) C[k] = D[k].v;
+  return num_candidates;
+}
+
+bool PIBT::funcPIBT(const int i)
+{
+  if (recursive_inheritance) return funcPIBTRecursive(i);
+  return funcPIBTIterative(i, stack, *MT, stats);
+}
+
+template <typename RNG>
+bool PIBT::funcPIBTIterative(const int i, Stack& stack, RNG& rng,
+                             Stats& counter)
+{
+  /*
+   * The same as funcPIBTRecursive, with an explicit stack.
+   * The top frame either tries its next candidate, descends to the agent
+   * occupying the candidate, or returns the result to its parent.
+   */
+  auto push = [&](const int i, const int j) {
+    stack.emplace_back();
+    Frame& f = stack.back();
+    f.i = i;
+    f.j = j;
+    f.num = getCandidates(i, f.C, rng);
+    f.k = 0;
+  };
+
+  push(i, NIL);
+  bool result = false;   // result of the last returned frame
+  bool resumed = false;  // whether the top frame resumes after its child
+  while (!stack.empty()) {
+    // child succeeded -> success to plan next one step
+    if (resumed && result) {
+      stack.pop_back();
+      continue;
+    }
+    // child failed -> try next candidate
+    if (resumed) counter.count(Stats::BACKTRACKS);
+    resumed = false;
 
-  for (auto u : C) {
+    const int depth = stack.size() - 1;
+    bool descended = false;
+    bool found = false;
+    while (stack[depth].k < stack[depth].num) {
+      Frame& f = stack[depth];
+      Node* u = f.C[f.k++];
+      // avoid conflicts
+      if (occupied_next[u->id] != NIL) continue;
+      if (f.j != NIL && u == v_now[f.j]) continue;
+
+      // reserve
+      occupied_next[u->id] = f.i;
+      v_next[f.i] = u;
+
+      auto l = occupied_now[u->id];
+      if (l != NIL && v_next[l] == nullptr) {
+        push(l, f.i);  // replanning
+        counter.count(Stats::INHERITANCES);
+        counter.countMax(Stats::MAX_INHERITANCE_DEPTH, stack.size() - 1);
+        descended = true;
+        break;
+      }
+      // success to plan next one step
+      found = true;
+      break;
+    }
+    if (descended) continue;
+
+    if (!found) {
+      // failed to secure node
+      const int k = stack[depth].i;
+      occupied_next[v_now[k]->id] = k;
+      v_next[k] = v_now[k];
+    }
+    result = found;
+    resumed = true;
+    stack.pop_back();
+  }
+
+  return result;
+}
+
+bool PIBT::funcPIBTRecursive(const int i, const int j)
+{
+  // get candidates
+  Node* C[MAX_CANDIDATES];
+  const int num_candidates = getCandidates(i, C, *MT);
+
+  for (int k = 0; k < num_candidates; ++k) {
+    Node* u = C[k];
     // avoid conflicts
-    if (occupied_next[u->id] != nullptr) continue;
-    if (aj != nullptr && u == aj->v_now) continue;
+    if (occupied_next[u->id] != NIL) continue;
+    if (j != NIL && u == v_now[j]) continue;
 
     // reserve
-    occupied_next[u->id] = ai;
-    ai->v_next = u;
+    occupied_next[u->id] = i;
+    v_next[i] = u;
 
-    auto ak = occupied_now[u->id];
-    if (ak != nullptr && ak->v_next == nullptr) {
-      if (!funcPIBT(ak, ai)) continue;  // replanning
+    auto l = occupied_now[u->id];
+    if (l != NIL && v_next[l] == nullptr) {
+      if (!funcPIBTRecursive(l, i)) continue;  // replanning
     }
     // success to plan next one step
     return true;
   }
 
   // failed to secure node
-  occupied_next[ai->v_now->id] = ai;
-  ai->v_next = ai->v_now;
+  occupied_next[v_now[i]->id] = i;
+  v_next[i] = v_now[i];
   return false;
 }
 
@@ -143,15 +386,23 @@ void PIBT::setParams(int argc, char* argv[])
 {
   struct option longopts[] = {
       {"disable-dist-init", no_argument, 0, 'd'},
+      {"parallel", no_argument, 0, 'p'},
+      {"move-table", no_argument, 0, 'm'},
       {0, 0, 0, 0},
   };
   optind = 1;  // reset
   int opt, longindex;
-  while ((opt = getopt_long(argc, argv, "d", longopts, &longindex)) != -1) {
+  while ((opt = getopt_long(argc, argv, "dpm", longopts, &longindex)) != -1) {
     switch (opt) {
       case 'd':
         disable_dist_init = true;
         break;
+      case 'p':
+        parallel = true;
+        break;
+      case 'm':
+        use_move_table = true;
+        break;
       default:
         break;
     }
@@ -164,5 +415,11 @@ void PIBT::printHelp()
             << "  -d --disable-dist-init"
             << "        "
             << "disable initialization of priorities "
-            << "using distance from starts to goals" << std::endl;
+            << "using distance from starts to goals\n"
+            << "  -p --parallel"
+            << "                "
+            << "plan independent clusters of agents in parallel\n"
+            << "  -m --move-table"
+            << "              "
+            << "order candidates by tables of moves" << std::endl;
 }
@@ -12,16 +12,15 @@ PIBT_MAPD::PIBT_MAPD(MAPD_Instance* _P, bool _use_distance_table)
 
 void PIBT_MAPD::run()
 {
-  // compare priority of agents
-  auto compare = [](Agent* a, const Agent* b) {
-    if (a->task != nullptr && b->task == nullptr) return true;
-    if (a->task == nullptr && b->task != nullptr) return false;
-
-    if (a->elapsed != b->elapsed) return a->elapsed > b->elapsed;
-    // use initial distance
-    return a->tie_breaker > b->tie_breaker;
-  };
+  // candidates are stored in fixed-size buffers
+  for (auto v : G->getV()) {
+    if (v != nullptr && (int)v->neighbor.size() + 1 > MAX_CANDIDATES) {
+      halt("too many neighbors, PIBT assumes four-connected grids");
+    }
+  }
+
   Agents A;
+  stack.reserve(P->getNum());
 
   // initialize
   for (int i = 0; i < P->getNum(); ++i) {
@@ -41,6 +40,16 @@ void PIBT_MAPD::run()
   }
   solution.add(P->getConfigStart());
 
+  // static part of priority: tie-breaker
+  const Agents agents = A;  // agent-id -> agent
+  std::vector<int> by_rank(P->getNum());
+  std::iota(by_rank.begin(), by_rank.end(), 0);
+  std::stable_sort(by_rank.begin(), by_rank.end(), [&](int a, int b) {
+    return agents[a]->tie_breaker > agents[b]->tie_breaker;
+  });
+  order.init(by_rank);
+  std::vector<int> keys(P->getNum());
+
   auto assign = [&](Agent* a, Task* task) {
     a->task = task;
     a->target_task = nullptr;
@@ -60,6 +69,7 @@ void PIBT_MAPD::run()
 
     // target assignment
     {
+      auto timer = stats.timer(Stats::ASSIGNMENT);
       Tasks unassigned_tasks;
       for (auto task : P->getOpenTasks()) {
         if (!task->assigned) unassigned_tasks.push_back(task);
@@ -107,13 +117,20 @@ void PIBT_MAPD::run()
         tasks.push_back(a->task);
       }
 
-      hist_targets.push_back(targets);
-      hist_tasks.push_back(tasks);
+      updateHistory(targets, tasks);
     }
 
     // planning
     {
-      std::sort(A.begin(), A.end(), compare);
+      auto timer = stats.timer(Stats::PLANNING);
+      // assigned agents first, then higher elapsed
+      int max_elapsed = 0;
+      for (auto a : A) max_elapsed = std::max(max_elapsed, a->elapsed);
+      for (auto a : A) {
+        keys[a->id] = a->elapsed + ((a->task != nullptr) ? max_elapsed + 1 : 0);
+      }
+      const auto& sorted = order.update(keys);
+      for (int k = 0; k < P->getNum(); ++k) A[k] = agents[sorted[k]];
       for (auto a : A) {
         // if the agent has next location, then skip
         if (a->v_next == nullptr) {
@@ -125,36 +142,41 @@ void PIBT_MAPD::run()
 
     // acting
     Config config(P->getNum(), nullptr);
-    for (auto a : A) {
-      // clear
-      if (occupied_now[a->v_now->id] == a) occupied_now[a->v_now->id] = nullptr;
-      occupied_next[a->v_next->id] = nullptr;
-
-      // set next location
-      config[a->id] = a->v_next;
-      occupied_now[a->v_next->id] = a;
-      // update priority
-      a->elapsed = (a->v_next == a->g) ? 0 : a->elapsed + 1;
-      // reset params
-      a->v_now = a->v_next;
-      a->v_next = nullptr;
-
-      // update task info
-      if (a->task != nullptr) {  // assigned agent
-        a->task->loc_current = a->v_now;
-
-        // finish
-        if (a->task->loc_current == a->task->loc_delivery) {
-          info("   ", "finish task-", a->task->id, ": agent-", a->id, ", ",
-               a->task->loc_pickup->id, " -> ", a->task->loc_delivery->id);
-
-          a->task = nullptr;
+    {
+      auto timer = stats.timer(Stats::ACTING);
+      for (auto a : A) {
+        // clear
+        if (occupied_now[a->v_now->id] == a) {
+          occupied_now[a->v_now->id] = nullptr;
         }
+        occupied_next[a->v_next->id] = nullptr;
+
+        // set next location
+        config[a->id] = a->v_next;
+        occupied_now[a->v_next->id] = a;
+        // update priority
+        a->elapsed = (a->v_next == a->g) ? 0 : a->elapsed + 1;
+        // reset params
+        a->v_now = a->v_next;
+        a->v_next = nullptr;
+
+        // update task info
+        if (a->task != nullptr) {  // assigned agent
+          a->task->loc_current = a->v_now;
+
+          // finish
+          if (a->task->loc_current == a->task->loc_delivery) {
+            info("   ", "finish task-", a->task->id, ": agent-", a->id, ", ",
+                 a->task->loc_pickup->id, " -> ", a->task->loc_delivery->id);
+
+            a->task = nullptr;
+          }
 
-      } else if (a->target_task != nullptr) {  // free agent
-        // assign
-        if (a->target_task->loc_pickup == a->v_now) {
-          assign(a, a->target_task);
+        } else if (a->target_task != nullptr) {  // free agent
+          // assign
+          if (a->target_task->loc_pickup == a->v_now) {
+            assign(a, a->target_task);
+          }
         }
       }
     }
@@ -186,15 +208,14 @@ void PIBT_MAPD::run()
       targets[a->id] = a->g;
       tasks[a->id] = a->task;
     }
-    hist_targets.push_back(targets);
-    hist_tasks.push_back(tasks);
+    updateHistory(targets, tasks);
   }
 
   // memory clear
   for (auto a : A) delete a;
 }
 
-bool PIBT_MAPD::funcPIBT(Agent* ai, Agent* aj)
+int PIBT_MAPD::getCandidates(Agent* ai, Node** C)
 {
   // compare two nodes
   auto compare = [&](Node* const v, Node* const u) {
@@ -210,15 +231,93 @@ bool PIBT_MAPD::funcPIBT(Agent* ai, Agent* aj)
     return false;
   };
 
-  // get candidates
-  Nodes C = ai->v_now->neighbor;
-  C.push_back(ai->v_now);
+  int num_candidates = 0;
+  for (auto u : ai->v_now->neighbor) C[num_candidates++] = u;
+  C[num_candidates++] = ai->v_now;
   // randomize
-  std::shuffle(C.begin(), C.end(), *MT);
+  std::shuffle(C, C + num_candidates, *MT);
   // sort
-  std::sort(C.begin(), C.end(), compare);
+  std::sort(C, C + num_candidates, compare);
+  return num_candidates;
+}
+
+bool PIBT_MAPD::funcPIBT(Agent* ai)
+{
+  if (recursive_inheritance) return funcPIBTRecursive(ai);
+
+  // the same as funcPIBTRecursive, with an explicit stack, see PIBT::funcPIBT
+  auto push = [&](Agent* ai, Agent* aj) {
+    stack.emplace_back();
+    Frame& f = stack.back();
+    f.ai = ai;
+    f.aj = aj;
+    f.num = getCandidates(ai, f.C);
+    f.k = 0;
+  };
+
+  push(ai, nullptr);
+  bool result = false;   // result of the last returned frame
+  bool resumed = false;  // whether the top frame resumes after its child
+  while (!stack.empty()) {
+    // child succeeded -> success to plan next one step
+    if (resumed && result) {
+      stack.pop_back();
+      continue;
+    }
+    // child failed -> try next candidate
+    if (resumed) stats.count(Stats::BACKTRACKS);
+    resumed = false;
+
+    const int depth = stack.size() - 1;
+    bool descended = false;
+    bool found = false;
+    while (stack[depth].k < stack[depth].num) {
+      Frame& f = stack[depth];
+      Node* u = f.C[f.k++];
+      // avoid conflicts
+      if (occupied_next[u->id] != nullptr) continue;
+      if (f.aj != nullptr && u == f.aj->v_now) continue;
+
+      // reserve
+      occupied_next[u->id] = f.ai;
+      f.ai->v_next = u;
+
+      auto ak = occupied_now[u->id];
+      if (ak != nullptr && ak->v_next == nullptr) {
+        push(ak, f.ai);  // replanning
+        stats.count(Stats::INHERITANCES);
+        stats.countMax(Stats::MAX_INHERITANCE_DEPTH, stack.size() - 1);
+        descended = true;
+        break;
+      }
+      // success to plan next one step
+      found = true;
+      break;
+    }
+    if (descended) continue;
+
+    if (!found) {
+      // failed to secure node
+      Agent* a = stack[depth].ai;
+      occupied_next[a->v_now->id] = a;
+      a->v_next = a->v_now;
+    }
+    result = found;
+    resumed = true;
+    stack.pop_back();
+  }
+
+  return result;
+}
+
+bool PIBT_MAPD::funcPIBTRecursive(Agent* ai, Agent* aj)
+{
+  // get candidates
+  Node* C[MAX_CANDIDATES];
+  const int num_candidates = getCandidates(ai, C);
 
-  for (auto u : C) {
+  for (int k = 0; k < num_candidates; ++k) {
+    Node* u = C[k];
     // avoid conflicts
     if (occupied_next[u->id] != nullptr) continue;
     if (aj != nullptr && u == aj->v_now) continue;
@@ -229,7 +328,7 @@ bool PIBT_MAPD::funcPIBT(Agent* ai, Agent* aj)
 
     auto ak = occupied_now[u->id];
     if (ak != nullptr && ak->v_next == nullptr) {
-      if (!funcPIBT(ak, ai)) continue;  // replanning
+      if (!funcPIBTRecursive(ak, ai)) continue;  // replanning
     }
     // success to plan next one step
     return true;
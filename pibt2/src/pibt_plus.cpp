@@ -31,6 +31,7 @@ void PIBT_PLUS::run()
   info(" ", "run PIBT until timestep", LB_makespan);
   init_solver->solve();
   solution = init_solver->getSolution();
+  stats.merge(init_solver->getStats());
 
   if (init_solver->succeed()) {  // PIBT success
     solved = true;
@@ -54,6 +55,7 @@ void PIBT_PLUS::run()
     // solve
     comp_solver->solve();
     solution += comp_solver->getSolution();
+    stats.merge(comp_solver->getStats());
     if (comp_solver->succeed()) solved = true;
 
     comp_time_complement = getElapsedTime(t_complement);
@@ -66,15 +68,9 @@ void PIBT_PLUS::printHelp()
             << "  (none)" << std::endl;
 }
 
-void PIBT_PLUS::makeLog(const std::string& logfile)
+void PIBT_PLUS::makeLogBasicInfo(std::ostream& log)
 {
-  std::ofstream log;
-  log.open(logfile, std::ios::out);
-  makeLogBasicInfo(log);
-
+  MAPF_Solver::makeLogBasicInfo(log);
   // print additional info
   log << "comp_time_complement=" << comp_time_complement << "\n";
-
-  makeLogSolution(log);
-  log.close();
 }
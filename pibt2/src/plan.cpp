@@ -1,59 +1,217 @@
 #include "../include/plan.hpp"
 
-Config Plan::get(const int t) const
+#include "../include/thread_pool.hpp"
+
+void Plan::setCompact(const bool _compact)
+{
+  if (!empty()) halt("invalid operation");
+  compact = _compact;
+}
+
+int Plan::getNumAgents() const
+{
+  if (empty()) return 0;
+  return compact ? tail.size() : configs[0].size();
+}
+
+int Plan::findBlock(const int t) const
+{
+  auto itr = std::upper_bound(
+      blocks.begin(), blocks.end(), t,
+      [](const int t, const Block& b) { return t < b.t0; });
+  return (itr - blocks.begin()) - 1;
+}
+
+int Plan::getCode(const Block& b, const int s, const int i, const int n)
+{
+  const size_t bit = ((size_t)(s - 1) * n + i) * CODE_BITS;
+  const int word = b.codes[bit >> 3] | (b.codes[(bit >> 3) + 1] << 8);
+  return (word >> (bit & 7)) & MAX_CODE;
+}
+
+int Plan::getMoveCode(Node* v, Node* u)
+{
+  if (v == u) return 0;
+  const int degree = std::min((int)v->neighbor.size(), MAX_CODE);
+  for (int k = 0; k < degree; ++k) {
+    if (v->neighbor[k] == u) return k + 1;
+  }
+  return -1;
+}
+
+void Plan::addCompact(const Config& c)
+{
+  const int n = c.size();
+
+  // moves from the last configuration
+  std::vector<uint8_t> step;
+  if (!blocks.empty() && blocks.back().len < BLOCK_SIZE) {
+    step.resize(n);
+    for (int i = 0; i < n; ++i) {
+      const int code = getMoveCode(tail[i], c[i]);
+      if (code < 0) {
+        step.clear();
+        break;
+      }
+      step[i] = code;
+    }
+  }
+
+  if (step.empty()) {
+    // new checkpoint
+    const int t0 = blocks.empty() ? offset : size();
+    const size_t bits = (size_t)(BLOCK_SIZE - 1) * n * CODE_BITS;
+    blocks.push_back({t0, 1, c, {}});
+    // one more byte, codes are read by two bytes
+    blocks.back().codes.reserve((bits + 7) / 8 + 1);
+  } else {
+    Block& b = blocks.back();
+    const size_t bit_begin = (size_t)(b.len - 1) * n * CODE_BITS;
+    b.codes.resize((bit_begin + (size_t)n * CODE_BITS + 7) / 8 + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      const size_t bit = bit_begin + (size_t)i * CODE_BITS;
+      const int word = step[i] << (bit & 7);
+      b.codes[bit >> 3] |= word & 0xff;
+      b.codes[(bit >> 3) + 1] |= word >> 8;
+    }
+    ++b.len;
+  }
+  tail = c;
+}
+
+const Config& Plan::at(const int t) const
 {
-  const int configs_size = configs.size();
-  if (!(0 <= t && t < configs_size)) halt("invalid timestep");
-  return configs[t];
+  if (!(offset <= t && t < size())) halt("invalid timestep");
+  if (!compact) return configs[t - offset];
+  if (t == size() - 1) return tail;
+
+  const Block& b = blocks[findBlock(t)];
+  if (!(b.t0 <= cursor_t && cursor_t <= t)) {
+    cursor = b.checkpoint;
+    cursor_t = b.t0;
+  }
+  const int n = cursor.size();
+  for (; cursor_t < t; ++cursor_t) {
+    const int s = cursor_t - b.t0 + 1;
+    for (int i = 0; i < n; ++i) {
+      const int code = getCode(b, s, i, n);
+      if (code != 0) cursor[i] = cursor[i]->neighbor[code - 1];
+    }
+  }
+  return cursor;
 }
 
+Config Plan::get(const int t) const { return at(t); }
+
 Node* Plan::get(const int t, const int i) const
 {
   if (empty()) halt("invalid operation");
-  if (!(0 <= t && t < (int)configs.size())) halt("invalid timestep");
-  if (!(0 <= i && i < (int)configs[0].size())) halt("invalid agent id");
-  return configs[t][i];
+  if (!(offset <= t && t < size())) halt("invalid timestep");
+  if (!(0 <= i && i < getNumAgents())) halt("invalid agent id");
+  if (!compact) return configs[t - offset][i];
+  if (t == size() - 1) return tail[i];
+
+  // one step forward, e.g., accessing timestep by timestep
+  if (t == cursor_t || t == cursor_t + 1) return at(t)[i];
+
+  // otherwise, replay only agent i
+  const Block& b = blocks[findBlock(t)];
+  const int n = tail.size();
+  Node* v = b.checkpoint[i];
+  for (int s = 1; s <= t - b.t0; ++s) {
+    const int code = getCode(b, s, i, n);
+    if (code != 0) v = v->neighbor[code - 1];
+  }
+  return v;
 }
 
 Path Plan::getPath(const int i) const
 {
   Path path;
-  int makespan = getMakespan();
-  for (int t = 0; t <= makespan; ++t) path.push_back(get(t, i));
+  if (!compact) {
+    int makespan = getMakespan();
+    for (int t = 0; t <= makespan; ++t) path.push_back(get(t, i));
+    return path;
+  }
+
+  if (offset > 0) halt("invalid timestep");
+  if (!(0 <= i && i < getNumAgents())) halt("invalid agent id");
+  const int n = tail.size();
+  for (auto& b : blocks) {
+    Node* v = b.checkpoint[i];
+    path.push_back(v);
+    for (int s = 1; s < b.len; ++s) {
+      const int code = getCode(b, s, i, n);
+      if (code != 0) v = v->neighbor[code - 1];
+      path.push_back(v);
+    }
+  }
   return path;
 }
 
 Config Plan::last() const
 {
   if (empty()) halt("invalid operation");
-  return configs[getMakespan()];
+  return compact ? tail : configs.back();
 }
 
 Node* Plan::last(const int i) const
 {
   if (empty()) halt("invalid operation");
-  if (i < 0 || (int)configs[0].size() <= i) halt("invalid operation");
-  return configs[getMakespan()][i];
+  if (i < 0 || getNumAgents() <= i) halt("invalid operation");
+  return compact ? tail[i] : configs.back()[i];
+}
+
+void Plan::clear()
+{
+  configs.clear();
+  blocks.clear();
+  tail.clear();
+  cursor_t = -1;
+  offset = 0;
 }
 
-void Plan::clear() { configs.clear(); }
+void Plan::drop(const int t)
+{
+  const int t_keep = std::min(t, size() - 1);
+  if (t_keep <= offset) return;
+  if (compact) {
+    // by blocks, the block including t_keep remains
+    while (blocks.size() > 1 && blocks[1].t0 <= t_keep) blocks.pop_front();
+    offset = blocks.front().t0;
+    return;
+  }
+  configs.erase(configs.begin(), configs.begin() + (t_keep - offset));
+  offset = t_keep;
+}
 
 void Plan::add(const Config& c)
 {
-  if (!configs.empty() && configs.at(0).size() != c.size()) {
+  if (!empty() && getNumAgents() != (int)c.size()) {
     halt("invalid operation");
   }
-  configs.push_back(c);
+  if (compact) {
+    addCompact(c);
+  } else {
+    configs.push_back(c);
+  }
 }
 
-bool Plan::empty() const { return configs.empty(); }
+bool Plan::empty() const { return compact ? blocks.empty() : configs.empty(); }
 
-int Plan::size() const { return configs.size(); }
+int Plan::size() const
+{
+  if (compact) {
+    return blocks.empty() ? offset : blocks.back().t0 + blocks.back().len;
+  }
+  return offset + configs.size();
+}
 
 int Plan::getMakespan() const { return size() - 1; }
 
 int Plan::getPathCost(const int i) const
 {
+  if (compact) return ::getPathCost(getPath(i));
   const int makespan = getMakespan();
   const Node* g = get(makespan, i);
   int c = makespan;
@@ -83,16 +241,17 @@ Plan Plan::operator+(const Plan& other) const
     if (c1[i] != c2[i]) halt("invalid operation.");
   }
   // merge
-  Plan new_plan;
-  new_plan.configs = configs;
+  Plan new_plan = *this;
   for (int t = 1; t < other.size(); ++t) new_plan.add(other.get(t));
   return new_plan;
 }
 
 void Plan::operator+=(const Plan& other)
 {
-  if (configs.empty()) {
-    configs = other.configs;
+  if (empty()) {
+    // keep the representation of this plan
+    offset = other.offset;
+    for (int t = offset; t < other.size(); ++t) add(other.get(t));
     return;
   }
   // check validity
@@ -101,12 +260,12 @@ void Plan::operator+=(const Plan& other)
   for (int t = 1; t < other.size(); ++t) add(other.get(t));
 }
 
-bool Plan::validate(MAPF_Instance* P) const
+bool Plan::validate(MAPF_Instance* P, const int num_threads) const
 {
-  return validate(P->getConfigStart(), P->getConfigGoal());
+  return validate(P->getConfigStart(), P->getConfigGoal(), num_threads);
 }
 
-bool Plan::validate(MAPD_Instance* P) const
+bool Plan::validate(MAPD_Instance* P, const int num_threads) const
 {
   // check tasks
   if ((int)P->getOpenTasks().size() > 0) {
@@ -125,69 +284,188 @@ bool Plan::validate(MAPD_Instance* P) const
     return false;
   }
 
-  return validate(P->getConfigStart());
+  return validate(P->getConfigStart(), num_threads);
 }
 
-bool Plan::validate(const Config& starts, const Config& goals) const
+bool Plan::validate(const Config& starts, const Config& goals,
+                    const int num_threads) const
 {
-  // check goal
-  if (!sameConfig(last(), goals)) {
+  if (goals.empty()) {
     warn("validation, invalid goals");
     return false;
   }
-  return validate(starts);
+  const auto conflict = findConflict(starts, goals, num_threads);
+  if (conflict.kind == Conflict::NONE) return true;
+  warn("validation, " + conflict.toString());
+  return false;
 }
 
-bool Plan::validate(const Config& starts) const
+bool Plan::validate(const Config& starts, const int num_threads) const
 {
-  if (configs.empty()) return false;
+  const auto conflict = findConflict(starts, {}, num_threads);
+  if (conflict.kind == Conflict::NONE) return true;
+  warn("validation, " + conflict.toString());
+  return false;
+}
 
-  // start
-  if (!sameConfig(starts, get(0))) {
-    warn("validation, invalid starts");
-    return false;
+std::string Plan::Conflict::toString() const
+{
+  auto at = [&](const int k) {
+    return "agent-" + std::to_string(k) + " at t=" + std::to_string(t) +
+           (v != nullptr ? ", v=" + std::to_string(v->id) : "");
+  };
+  switch (kind) {
+    case NONE:
+      return "no conflict";
+    case EMPTY:
+      return "empty plan";
+    case DROPPED:
+      return "configurations are dropped";
+    case SIZE:
+      return "invalid size at t=" + std::to_string(t);
+    case START:
+      return "invalid starts, " + at(i);
+    case GOAL:
+      return "invalid goals, " + at(i);
+    case MOVE:
+      return "invalid move, " + at(i);
+    case VERTEX:
+      return "vertex conflict, agent-" + std::to_string(j) + " and " + at(i);
+    case SWAP:
+      return "swap conflict, agent-" + std::to_string(j) + " and " + at(i);
+    default:
+      return "";
   }
+}
 
-  // check conflicts and continuity
-  int num_agents = get(0).size();
-  for (int t = 1; t <= getMakespan(); ++t) {
-    if ((int)configs[t].size() != num_agents) {
-      warn("validation, invalid size");
-      return false;
+Plan::Conflict Plan::findConflict(const Config& starts, const Config& goals,
+                                  const int num_threads) const
+{
+  Conflict conflict;
+  auto report = [&](const Conflict::Kind kind, const int t, const int i) {
+    conflict.kind = kind;
+    conflict.t = t;
+    conflict.i = i;
+    return conflict;
+  };
+  if (empty()) return report(Conflict::EMPTY, -1, -1);
+  if (offset > 0) return report(Conflict::DROPPED, offset, -1);
+
+  // start and goal
+  const int num_agents = starts.size();
+  const int makespan = getMakespan();
+  for (int k = 0; k < 2; ++k) {
+    const Config& c = (k == 0) ? starts : goals;
+    if (k == 1 && goals.empty()) break;
+    const int t = (k == 0) ? 0 : makespan;
+    const Config& c_t = at(t);
+    if ((int)c.size() != num_agents || (int)c_t.size() != num_agents) {
+      return report(Conflict::SIZE, t, -1);
     }
     for (int i = 0; i < num_agents; ++i) {
-      Node* v_i_t = get(t, i);
-      Node* v_i_t_1 = get(t - 1, i);
-      Nodes cands = v_i_t_1->neighbor;
-      cands.push_back(v_i_t_1);
-      if (!inArray(v_i_t, cands)) {
-        warn("validation, invalid move at t=" + std::to_string(t));
-        return false;
+      if (c[i] != c_t[i]) {
+        report(k == 0 ? Conflict::START : Conflict::GOAL, t, i);
+        conflict.v = c_t[i];
+        return conflict;
       }
-      // see conflicts
-      for (int j = i + 1; j < num_agents; ++j) {
-        Node* v_j_t = get(t, j);
-        Node* v_j_t_1 = get(t - 1, j);
-        if (v_i_t == v_j_t) {
-          warn("validation, vertex conflict at v=" + std::to_string(v_i_t->id) +
-               ", t=" + std::to_string(t));
-          return false;
-        }
-        if (v_i_t == v_j_t_1 && v_i_t_1 == v_j_t) {
-          warn("validation, swap conflict");
-          return false;
+    }
+  }
+
+  // chunks of timesteps, the first conflict is of the first chunk having one
+  ThreadPool pool(compact ? 1 : num_threads);
+  if (pool.size() == 1) return findConflict(1, makespan + 1);
+  const int num_chunks = std::min(makespan, pool.size() * 4);
+  std::vector<Conflict> results(num_chunks);
+  pool.parallelFor(num_chunks, [&](int k) {
+    const int t_begin = 1 + (int64_t)makespan * k / num_chunks;
+    const int t_end = 1 + (int64_t)makespan * (k + 1) / num_chunks;
+    results[k] = findConflict(t_begin, t_end);
+  });
+  for (auto& c : results) {
+    if (c.kind != Conflict::NONE) return c;
+  }
+  return conflict;
+}
+
+Plan::Conflict Plan::findConflict(const int t_begin, const int t_end) const
+{
+  Conflict conflict;
+  auto report = [&](const Conflict::Kind kind, const int t, const int i,
+                    const int j, Node* v) {
+    conflict.kind = kind;
+    conflict.t = t;
+    conflict.i = i;
+    conflict.j = j;
+    conflict.v = v;
+    return conflict;
+  };
+  if (t_begin >= t_end) return conflict;
+
+  // node-id -> agent at t - 1 and t, extended on demand
+  static constexpr int NIL = -1;
+  std::vector<int> occupied_prev;
+  std::vector<int> occupied_now;
+  auto occupy = [](std::vector<int>& occupied, Node* v, const int i) {
+    if (v->id >= (int)occupied.size()) occupied.resize(v->id + 1, NIL);
+    const int j = occupied[v->id];
+    occupied[v->id] = i;
+    return j;
+  };
+  auto occupant = [](const std::vector<int>& occupied, Node* v) {
+    return v->id < (int)occupied.size() ? occupied[v->id] : NIL;
+  };
+
+  Config c_t_1 = at(t_begin - 1);  // copy, at() of compact plans is reused
+  const int num_agents = c_t_1.size();
+  for (int i = 0; i < num_agents; ++i) occupy(occupied_prev, c_t_1[i], i);
+
+  for (int t = t_begin; t < t_end; ++t) {
+    const Config& c_t = at(t);
+    if ((int)c_t.size() != num_agents) {
+      return report(Conflict::SIZE, t, -1, -1, nullptr);
+    }
+    for (int i = 0; i < num_agents; ++i) {
+      Node* v = c_t[i];
+      Node* u = c_t_1[i];
+      if (v != u) {
+        // continuity
+        auto& nbr = u->neighbor;
+        if (std::find(nbr.begin(), nbr.end(), v) == nbr.end()) {
+          return report(Conflict::MOVE, t, i, -1, v);
         }
+        // swap, agent j moves from v to u
+        const int j = occupant(occupied_prev, v);
+        if (j != NIL && c_t[j] == u) return report(Conflict::SWAP, t, i, j, v);
       }
+      // vertex
+      const int j = occupy(occupied_now, v, i);
+      if (j != NIL) return report(Conflict::VERTEX, t, i, j, v);
     }
+
+    // reuse, occupancy of t becomes the previous one
+    for (auto u : c_t_1) occupied_prev[u->id] = NIL;
+    std::swap(occupied_prev, occupied_now);
+    c_t_1 = c_t;
   }
-  return true;
+  return conflict;
 }
 
 int Plan::getMaxConstraintTime(const int id, Node* s, Node* g, Graph* G) const
 {
   const int makespan = getMakespan();
   const int dist = G->pathDist(s, g);
-  const int num = configs[0].size();
+  const int num = getNumAgents();
+  if (compact) {
+    // forward, replaying backward restarts from checkpoints
+    int t_max = 0;
+    for (int t = dist; t < makespan; ++t) {
+      const Config& c = at(t);
+      for (int i = 0; i < num; ++i) {
+        if (i != id && c[i] == g) t_max = t;
+      }
+    }
+    return t_max;
+  }
   for (int t = makespan - 1; t >= dist; --t) {
     for (int i = 0; i < num; ++i) {
       if (i != id && get(t, i) == g) return t;
@@ -0,0 +1,32 @@
+#include "../include/priority_order.hpp"
+
+#include <algorithm>
+
+void PriorityOrder::init(const std::vector<int>& _by_rank)
+{
+  by_rank = _by_rank;
+  order = _by_rank;
+}
+
+const std::vector<int>& PriorityOrder::update(const std::vector<int>& keys)
+{
+  int max_key = 0;
+  for (auto i : by_rank) max_key = std::max(max_key, keys[i]);
+
+  // count agents of each key
+  counts.assign(max_key + 1, 0);
+  for (auto i : by_rank) ++counts[keys[i]];
+
+  // start positions, higher keys first
+  int pos = 0;
+  for (int k = max_key; k >= 0; --k) {
+    const int num = counts[k];
+    counts[k] = pos;
+    pos += num;
+  }
+
+  // stable with respect to the static rank
+  for (auto i : by_rank) order[counts[keys[i]]++] = i;
+
+  return order;
+}
@@ -1,10 +1,93 @@
 #include "../include/problem.hpp"
 
+#include <charconv>
 #include <fstream>
-#include <regex>
+#include <string_view>
 
 #include "../include/util.hpp"
 
+namespace
+{
+  // whole file -> buf, false when not found
+  bool readFile(const std::string& filename, std::string& buf)
+  {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file) return false;
+    file.seekg(0, std::ios::end);
+    buf.resize(file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(&buf[0], buf.size());
+    return true;
+  }
+
+  // lines of a buffer without copies, as std::getline
+  struct LineReader {
+    const std::string_view buf;
+    size_t pos = 0;
+
+    LineReader(const std::string& _buf) : buf(_buf) {}
+
+    bool next(std::string_view& line)
+    {
+      if (pos >= buf.size()) return false;
+      size_t end = buf.find('\n', pos);
+      if (end == std::string_view::npos) end = buf.size();
+      line = buf.substr(pos, end - pos);
+      pos = end + 1;
+      // for CRLF coding
+      if (!line.empty() && line.back() == 0x0d) line.remove_suffix(1);
+      return true;
+    }
+  };
+
+  // the same as regex "#.+"
+  bool isComment(std::string_view line)
+  {
+    return line.size() >= 2 && line[0] == '#';
+  }
+
+  // the same as regex "key=(.+)"
+  bool matchValue(std::string_view line, std::string_view key,
+                  std::string_view& value)
+  {
+    if (line.size() <= key.size() + 1) return false;
+    if (line.compare(0, key.size(), key) != 0) return false;
+    if (line[key.size()] != '=') return false;
+    value = line.substr(key.size() + 1);
+    return value.find(0x0d) == std::string_view::npos;
+  }
+
+  // the same as regex "\d+", false when out of int
+  bool parseInt(std::string_view s, int& x)
+  {
+    if (s.empty()) return false;
+    for (auto c : s) {
+      if (c < '0' || '9' < c) return false;
+    }
+    auto res = std::from_chars(s.data(), s.data() + s.size(), x);
+    return res.ec == std::errc();
+  }
+
+  // the same as regex "key=(\d+)"
+  bool matchInt(std::string_view line, std::string_view key, int& x)
+  {
+    std::string_view value;
+    return matchValue(line, key, value) && parseInt(value, x);
+  }
+
+  // the same as regex "(\d+),(\d+),...", num values
+  bool matchInts(std::string_view line, int* values, const int num)
+  {
+    for (int k = 0; k < num - 1; ++k) {
+      const size_t comma = line.find(',');
+      if (comma == std::string_view::npos) return false;
+      if (!parseInt(line.substr(0, comma), values[k])) return false;
+      line.remove_prefix(comma + 1);
+    }
+    return parseInt(line, values[num - 1]);
+  }
+}  // namespace
+
 Problem::Problem(std::string _instance, Graph* _G, std::mt19937* _MT,
                  Config _config_s, Config _config_g, int _num_agents,
                  int _max_timestep, int _max_comp_time)
@@ -45,51 +128,50 @@ void Problem::warn(const std::string& msg) const
 // MAPF
 
 MAPF_Instance::MAPF_Instance(const std::string& _instance)
+    : MAPF_Instance(_instance, nullptr)
+{
+}
+
+MAPF_Instance::MAPF_Instance(const std::string& _instance,
+                             const MapLoader& load_map, const int seed)
     : Problem(_instance), instance_initialized(true)
 {
   // read instance file
-  std::ifstream file(instance);
-  if (!file) halt("file " + instance + " is not found.");
-
-  std::string line;
-  std::smatch results;
-  std::regex r_comment = std::regex(R"(#.+)");
-  std::regex r_map = std::regex(R"(map_file=(.+))");
-  std::regex r_agents = std::regex(R"(agents=(\d+))");
-  std::regex r_seed = std::regex(R"(seed=(\d+))");
-  std::regex r_random_problem = std::regex(R"(random_problem=(\d+))");
-  std::regex r_well_formed = std::regex(R"(well_formed=(\d+))");
-  std::regex r_max_timestep = std::regex(R"(max_timestep=(\d+))");
-  std::regex r_max_comp_time = std::regex(R"(max_comp_time=(\d+))");
-  std::regex r_sg = std::regex(R"((\d+),(\d+),(\d+),(\d+))");
+  std::string buf;
+  if (!readFile(instance, buf)) halt("file " + instance + " is not found.");
+
+  LineReader reader(buf);
+  std::string_view line, value;
+  int x;
+  int sg[4];
 
   bool read_scen = true;
   bool well_formed = false;
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
+  while (reader.next(line)) {
     // comment
-    if (std::regex_match(line, results, r_comment)) {
+    if (isComment(line)) {
       continue;
     }
     // read map
-    if (std::regex_match(line, results, r_map)) {
-      G = new Grid(results[1].str());
+    if (matchValue(line, "map_file", value)) {
+      own_graph = (load_map == nullptr);
+      G = own_graph ? new Grid(std::string(value))
+                    : load_map(std::string(value));
       continue;
     }
     // set agent num
-    if (std::regex_match(line, results, r_agents)) {
-      num_agents = std::stoi(results[1].str());
+    if (matchInt(line, "agents", x)) {
+      num_agents = x;
       continue;
     }
     // set random seed
-    if (std::regex_match(line, results, r_seed)) {
-      MT = new std::mt19937(std::stoi(results[1].str()));
+    if (matchInt(line, "seed", x)) {
+      MT = new std::mt19937(x);
       continue;
     }
     // skip reading initial/goal nodes
-    if (std::regex_match(line, results, r_random_problem)) {
-      if (std::stoi(results[1].str())) {
+    if (matchInt(line, "random_problem", x)) {
+      if (x) {
         read_scen = false;
         config_s.clear();
         config_g.clear();
@@ -97,27 +179,27 @@ MAPF_Instance::MAPF_Instance(const std::string& _instance)
       continue;
     }
     //
-    if (std::regex_match(line, results, r_well_formed)) {
-      if (std::stoi(results[1].str())) well_formed = true;
+    if (matchInt(line, "well_formed", x)) {
+      if (x) well_formed = true;
       continue;
     }
     // set max timestep
-    if (std::regex_match(line, results, r_max_timestep)) {
-      max_timestep = std::stoi(results[1].str());
+    if (matchInt(line, "max_timestep", x)) {
+      max_timestep = x;
       continue;
     }
     // set max computation time
-    if (std::regex_match(line, results, r_max_comp_time)) {
-      max_comp_time = std::stoi(results[1].str());
+    if (matchInt(line, "max_comp_time", x)) {
+      max_comp_time = x;
       continue;
     }
     // read initial/goal nodes
-    if (std::regex_match(line, results, r_sg) && read_scen &&
-        (int)config_s.size() < num_agents) {
-      int x_s = std::stoi(results[1].str());
-      int y_s = std::stoi(results[2].str());
-      int x_g = std::stoi(results[3].str());
-      int y_g = std::stoi(results[4].str());
+    if (read_scen && (int)config_s.size() < num_agents &&
+        matchInts(line, sg, 4)) {
+      int x_s = sg[0];
+      int y_s = sg[1];
+      int x_g = sg[2];
+      int y_g = sg[3];
       if (!G->existNode(x_s, y_s)) {
         halt("start node (" + std::to_string(x_s) + ", " + std::to_string(y_s) +
              ") does not exist, invalid scenario");
@@ -135,6 +217,10 @@ MAPF_Instance::MAPF_Instance(const std::string& _instance)
   }
 
   // set default value not identified params
+  if (seed >= 0) {
+    if (MT != nullptr) delete MT;
+    MT = new std::mt19937(seed);
+  }
   if (MT == nullptr) MT = new std::mt19937(DEFAULT_SEED);
   if (max_timestep == 0) max_timestep = DEFAULT_MAX_TIMESTEP;
   if (max_comp_time == 0) max_comp_time = DEFAULT_MAX_COMP_TIME;
@@ -178,7 +264,7 @@ MAPF_Instance::MAPF_Instance(MAPF_Instance* P, int _max_comp_time)
 MAPF_Instance::~MAPF_Instance()
 {
   if (instance_initialized) {
-    if (G != nullptr) delete G;
+    if (G != nullptr && own_graph) delete G;
     if (MT != nullptr) delete MT;
   }
 }
@@ -299,75 +385,63 @@ MAPD_Instance::MAPD_Instance(const std::string& _instance)
     : Problem(_instance), current_timestep(-1), specify_pickup_deliv_locs(true)
 {
   // read instance file
-  std::ifstream file(instance);
-  if (!file) halt("file " + instance + " is not found.");
-
-  std::string line;
-  std::smatch results;
-  std::regex r_comment = std::regex(R"(#.+)");
-  std::regex r_map = std::regex(R"(map_file=(.+))");
-  std::regex r_agents = std::regex(R"(agents=(\d+))");
-  std::regex r_seed = std::regex(R"(seed=(\d+))");
-  std::regex r_max_timestep = std::regex(R"(max_timestep=(\d+))");
-  std::regex r_max_comp_time = std::regex(R"(max_comp_time=(\d+))");
-  std::regex r_task_num = std::regex(R"(task_num=(\d+))");
-  std::regex r_task_frequency = std::regex(R"(task_frequency=(.+))");
-  std::regex r_specify_pikup_deliv_locs =
-      std::regex(R"(specify_pikup_deliv_locs=(\d+))");
-  std::regex r_sg = std::regex(R"((\d+),(\d+))");
-
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
+  std::string buf;
+  if (!readFile(instance, buf)) halt("file " + instance + " is not found.");
+
+  LineReader reader(buf);
+  std::string_view line, value;
+  int x;
+  int sg[2];
+
+  while (reader.next(line)) {
     // comment
-    if (std::regex_match(line, results, r_comment)) {
+    if (isComment(line)) {
       continue;
     }
     // read map
-    if (std::regex_match(line, results, r_map)) {
-      G = new Grid(results[1].str());
+    if (matchValue(line, "map_file", value)) {
+      G = new Grid(std::string(value));
       continue;
     }
     // set agent num
-    if (std::regex_match(line, results, r_agents)) {
-      num_agents = std::stoi(results[1].str());
+    if (matchInt(line, "agents", x)) {
+      num_agents = x;
       continue;
     }
     // set random seed
-    if (std::regex_match(line, results, r_seed)) {
-      MT = new std::mt19937(std::stoi(results[1].str()));
+    if (matchInt(line, "seed", x)) {
+      MT = new std::mt19937(x);
       continue;
     }
     // set max timestep
-    if (std::regex_match(line, results, r_max_timestep)) {
-      max_timestep = std::stoi(results[1].str());
+    if (matchInt(line, "max_timestep", x)) {
+      max_timestep = x;
       continue;
     }
     // set max computation time
-    if (std::regex_match(line, results, r_max_comp_time)) {
-      max_comp_time = std::stoi(results[1].str());
+    if (matchInt(line, "max_comp_time", x)) {
+      max_comp_time = x;
       continue;
     }
     // set the number of tasks
-    if (std::regex_match(line, results, r_task_num)) {
-      task_num = std::stoi(results[1].str());
+    if (matchInt(line, "task_num", x)) {
+      task_num = x;
       continue;
     }
     // set task frequency
-    if (std::regex_match(line, results, r_task_frequency)) {
-      task_frequency = std::stof(results[1].str());
+    if (matchValue(line, "task_frequency", value)) {
+      task_frequency = std::stof(std::string(value));
       continue;
     }
     // set task frequency
-    if (std::regex_match(line, results, r_specify_pikup_deliv_locs)) {
-      specify_pickup_deliv_locs = (bool)std::stoi(results[1].str());
+    if (matchInt(line, "specify_pikup_deliv_locs", x)) {
+      specify_pickup_deliv_locs = (bool)x;
       continue;
     }
     // read initial nodes
-    if (std::regex_match(line, results, r_sg) &&
-        (int)config_s.size() < num_agents) {
-      int x_s = std::stoi(results[1].str());
-      int y_s = std::stoi(results[2].str());
+    if ((int)config_s.size() < num_agents && matchInts(line, sg, 2)) {
+      int x_s = sg[0];
+      int y_s = sg[1];
       if (!G->existNode(x_s, y_s)) {
         halt("start node (" + std::to_string(x_s) + ", " + std::to_string(y_s) +
              ") does not exist, invalid scenario");
@@ -432,6 +506,8 @@ MAPD_Instance::~MAPD_Instance()
 {
   for (auto task : TASKS_OPEN) delete task;
   for (auto task : TASKS_CLOSED) delete task;
+  if (G != nullptr) delete G;
+  if (MT != nullptr) delete MT;
 }
 
 void MAPD_Instance::setupSpetialNodes()
@@ -440,43 +516,37 @@ void MAPD_Instance::setupSpetialNodes()
 
   // read instance file
 #ifdef _MAPDIR_
-  std::ifstream file(_MAPDIR_ + grid->getMapFileName() + ".pd");
+  const std::string pd_file = _MAPDIR_ + grid->getMapFileName() + ".pd";
 #else
-  std::ifstream file(grid->getMapFileName() + ".pd");
+  const std::string pd_file = grid->getMapFileName() + ".pd";
 #endif
-  if (!file) return;
+  std::string buf;
+  if (!readFile(pd_file, buf)) return;
 
-  std::string line, s;
-  std::smatch results;
-  std::regex r_obj = std::regex(R"([@T])");
-  std::regex r_pickup = std::regex(R"([psa])");  // pickup loc.
-  std::regex r_deliv = std::regex(R"([dsa])");   // delivery loc.
-  std::regex r_end = std::regex(R"([ea])");      // end loc.
+  LineReader reader(buf);
+  std::string_view line;
 
   const int width = grid->getWidth();
 
   int y = 0;
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
-
+  while (reader.next(line)) {
     if ((int)line.size() != width) halt("pd format is invalid");
 
     for (int x = 0; x < width; ++x) {
       if (!G->existNode(x, y)) continue;
 
       auto v = G->getNode(x, y);
-      s = line[x];
+      const char s = line[x];
       bool flg_endpoints = false;
-      if (std::regex_match(s, results, r_pickup)) {
+      if (s == 'p' || s == 's' || s == 'a') {  // pickup loc.
         LOCS_PICKUP.push_back(v);
         flg_endpoints = true;
       }
-      if (std::regex_match(s, results, r_deliv)) {
+      if (s == 'd' || s == 's' || s == 'a') {  // delivery loc.
         LOCS_DELIVERY.push_back(v);
         flg_endpoints = true;
       }
-      if (std::regex_match(s, results, r_end)) {
+      if (s == 'e' || s == 'a') {  // end loc.
         LOCS_NONTASK_ENDPOINTS.push_back(v);
         flg_endpoints = true;
       }
@@ -15,6 +15,7 @@ PushAndSwap::PushAndSwap(MAPF_Instance* _P)
 
 void PushAndSwap::run()
 {
+  auto timer = stats.timer(Stats::PLANNING);
   solution.add(P->getConfigStart());
 
   // occupancy
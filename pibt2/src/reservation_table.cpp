@@ -0,0 +1,60 @@
+#include "../include/reservation_table.hpp"
+
+#include <algorithm>
+
+ReservationTable::ReservationTable(const int _nodes_size)
+    : words((_nodes_size + 63) / 64), horizon(0), parks(words, 0)
+{
+}
+
+void ReservationTable::reserve(const int t, Node* const v, const int agent)
+{
+  if (t >= horizon) {
+    horizon = t + 1;
+    bits.resize((size_t)horizon * words, 0);
+  }
+  bits[(size_t)t * words + (v->id >> 6)] |= 1ULL << (v->id & 63);
+  cells.set(getKey(t, v->id), agent);
+  stats.count(Stats::RESERVATIONS);
+}
+
+void ReservationTable::release(const int t, Node* const v)
+{
+  if (t >= horizon) return;
+  bits[(size_t)t * words + (v->id >> 6)] &= ~(1ULL << (v->id & 63));
+  cells.erase(getKey(t, v->id));
+}
+
+void ReservationTable::insert(const int agent, const Path& path, const int t0,
+                              const bool park)
+{
+  if (path.empty()) return;
+  for (int k = 0; k < (int)path.size(); ++k) reserve(t0 + k, path[k], agent);
+  if (park) {
+    const int v = path.back()->id;
+    parks[v >> 6] |= 1ULL << (v & 63);
+    parked.set(v, agent);
+    parked_from.set(v, t0 + (int)path.size() - 1);
+  }
+}
+
+void ReservationTable::remove(const Path& path, const int t0, const bool park)
+{
+  if (path.empty()) return;
+  for (int k = 0; k < (int)path.size(); ++k) release(t0 + k, path[k]);
+  if (park) {
+    const int v = path.back()->id;
+    parks[v >> 6] &= ~(1ULL << (v & 63));
+    parked.erase(v);
+    parked_from.erase(v);
+  }
+}
+
+void ReservationTable::clear()
+{
+  std::fill(bits.begin(), bits.end(), 0);
+  std::fill(parks.begin(), parks.end(), 0);
+  cells.clear();
+  parked.clear();
+  parked_from.clear();
+}
@@ -0,0 +1,78 @@
+#include "../include/search_utils.hpp"
+
+#include <algorithm>
+
+KeySet::KeySet(const int capacity) : generation(1), num(0)
+{
+  uint64_t size = 1;
+  while (size < (uint64_t)capacity) size <<= 1;
+  slots.assign(size, Slot{0, 0});
+  mask = size - 1;
+}
+
+void KeySet::grow()
+{
+  std::vector<Slot> old_slots(2 * slots.size(), Slot{0, 0});
+  old_slots.swap(slots);
+  mask = slots.size() - 1;
+  num = 0;
+  for (auto& slot : old_slots) {
+    if (slot.stamp == generation) insert(slot.key);
+  }
+}
+
+void KeySet::clear()
+{
+  if (++generation == 0) {  // wrap around
+    for (auto& slot : slots) slot.stamp = 0;
+    generation = 1;
+  }
+  num = 0;
+}
+
+KeyMap::KeyMap(const int capacity) : num(0)
+{
+  uint64_t size = 1;
+  while (size < (uint64_t)capacity) size <<= 1;
+  slots.assign(size, Slot{EMPTY, 0});
+  mask = size - 1;
+}
+
+void KeyMap::grow()
+{
+  std::vector<Slot> old_slots(2 * slots.size(), Slot{EMPTY, 0});
+  old_slots.swap(slots);
+  mask = slots.size() - 1;
+  num = 0;
+  for (auto& slot : old_slots) {
+    if (slot.key != EMPTY) set(slot.key, slot.value);
+  }
+}
+
+void KeyMap::erase(const uint64_t key)
+{
+  uint64_t i = hash(key) & mask;
+  while (slots[i].key != key) {
+    if (slots[i].key == EMPTY) return;  // not found
+    i = (i + 1) & mask;
+  }
+  // shift following keys back to keep probe sequences unbroken
+  uint64_t j = i;
+  while (true) {
+    j = (j + 1) & mask;
+    if (slots[j].key == EMPTY) break;
+    const uint64_t k = hash(slots[j].key) & mask;
+    // slot j can move to i iff its home k is not in (i, j] cyclically
+    if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+    slots[i] = slots[j];
+    i = j;
+  }
+  slots[i].key = EMPTY;
+  --num;
+}
+
+void KeyMap::clear()
+{
+  std::fill(slots.begin(), slots.end(), Slot{EMPTY, 0});
+  num = 0;
+}
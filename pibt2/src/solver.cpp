@@ -3,6 +3,8 @@
 #include <fstream>
 #include <iomanip>
 
+#include "../include/thread_pool.hpp"
+
 MinimumSolver::MinimumSolver(Problem* _P)
     : solver_name(""),
       G(_P->getG()),
@@ -12,7 +14,10 @@ MinimumSolver::MinimumSolver(Problem* _P)
       solved(false),
       comp_time(0),
       verbose(false),
-      log_short(false)
+      log_short(false),
+      num_threads(DEFAULT_NUM_THREADS),
+      load_distance_cache(false),
+      use_bucket_queue(false)
 {
 }
 
@@ -66,6 +71,44 @@ void MinimumSolver::warn(const std::string& msg) const
   std::cout << "warn@ " << solver_name << ": " << msg << std::endl;
 }
 
+// -------------------------------
+// instrumentation
+// -------------------------------
+Stats MinimumSolver::getStats() const
+{
+  Stats s = stats;
+  s.merge(astar_workspace.stats);
+  return s;
+}
+
+void MinimumSolver::makeStatsFile(const std::string& file) const
+{
+  if (!Stats::ENABLED) {
+    warn("instrumentation is disabled, build with -DPIBT2_STATS=ON");
+  }
+  std::ofstream log(file);
+  log << "{\"solver\": \"" << solver_name << "\", \"solved\": "
+      << (solved ? "true" : "false") << ", \"comp_time\": " << comp_time
+      << ", \"stats\": ";
+  getStats().writeJSON(log);
+  log << "}\n";
+}
+
+// -------------------------------
+// utilities for distance
+// -------------------------------
+void MinimumSolver::loadDistanceCache(DistanceCache* const cache) const
+{
+  const auto filename = DistanceCache::getCacheFileName(G);
+  if (filename.empty()) {
+    warn("distance cache is available only for grids");
+  } else if (cache->load(filename)) {
+    info("  load distance cache:", filename);
+  } else {
+    warn("distance cache " + filename + " is not available");
+  }
+}
+
 // -----------------------------------------------
 // base class with utilities
 // -----------------------------------------------
@@ -75,9 +118,10 @@ MAPF_Solver::MAPF_Solver(MAPF_Instance* _P)
       P(_P),
       LB_soc(0),
       LB_makespan(0),
-      distance_table(_P->getNum(),
-                     std::vector<int>(G->getNodesSize(), max_timestep)),
-      distance_table_p(nullptr)
+      distance_table_p(nullptr),
+      lazy_distance_table(false),
+      preprocessing_comp_time(0),
+      PATH_TABLE(G->getNodesSize())
 {
 }
 
@@ -90,8 +134,12 @@ void MAPF_Solver::exec()
 {
   // create distance table
   if (distance_table_p == nullptr) {
-    info("  pre-processing, create distance table by BFS");
-    createDistanceTable();
+    info("  pre-processing, create distance table by BFS",
+         lazy_distance_table ? "(lazy)" : "");
+    {
+      auto timer = stats.timer(Stats::DISTANCE_TABLE);
+      createDistanceTable();
+    }
     preprocessing_comp_time = getSolverElapsedTime();
     info("  done, elapsed: ", preprocessing_comp_time);
   }
@@ -126,20 +174,20 @@ int MAPF_Solver::getLowerBoundMakespan()
   return LB_makespan;
 }
 
+Stats MAPF_Solver::getStats() const
+{
+  Stats s = MinimumSolver::getStats();
+  s.merge(PATH_TABLE.getStats());
+  return s;
+}
+
 // -------------------------------
 // utilities for solution representation
 Paths MAPF_Solver::planToPaths(const Plan& plan)
 {
   int num_agents = plan.get(0).size();
   Paths paths(num_agents);
-  int makespan = plan.getMakespan();
-  for (int i = 0; i < num_agents; ++i) {
-    Path path;
-    for (int t = 0; t <= makespan; ++t) {
-      path.push_back(plan.get(t, i));
-    }
-    paths.insert(i, path);
-  }
+  for (int i = 0; i < num_agents; ++i) paths.insert(i, plan.getPath(i));
   return paths;
 }
 
@@ -201,6 +249,7 @@ void MinimumSolver::printHelpWithoutOption(const std::string& solver_name)
 // -------------------------------
 void MAPF_Solver::makeLog(const std::string& logfile)
 {
+  auto timer = stats.timer(Stats::LOGGING);
   std::ofstream log;
   log.open(logfile, std::ios::out);
   makeLogBasicInfo(log);
@@ -208,7 +257,32 @@ void MAPF_Solver::makeLog(const std::string& logfile)
   log.close();
 }
 
-void MAPF_Solver::makeLogBasicInfo(std::ofstream& log)
+void MAPF_Solver::makeLogBinary(const std::string& logfile)
+{
+  auto timer = stats.timer(Stats::LOGGING);
+  BinaryLog bin;
+  bin.kind = BinaryLog::MAPF;
+  std::ostringstream header;
+  makeLogBasicInfo(header);
+  bin.header = header.str();
+  bin.has_solution = !log_short;
+  if (bin.has_solution) {
+    const int num_agents = P->getNum();
+    bin.width = reinterpret_cast<Grid*>(G)->getWidth();
+    bin.num_agents = num_agents;
+    bin.num_timesteps = solution.size();
+    bin.paths.assign(num_agents, std::vector<int>(solution.size()));
+    for (int i = 0; i < num_agents; ++i) {
+      bin.starts.push_back(P->getStart(i)->id);
+      bin.goals.push_back(P->getGoal(i)->id);
+      const Path path = solution.getPath(i);
+      for (int t = 0; t < solution.size(); ++t) bin.paths[i][t] = path[t]->id;
+    }
+  }
+  if (!bin.write(logfile)) halt("failed to write " + logfile);
+}
+
+void MAPF_Solver::makeLogBasicInfo(std::ostream& log)
 {
   Grid* grid = reinterpret_cast<Grid*>(P->getG());
   log << "instance=" << P->getInstanceFileName() << "\n";
@@ -222,6 +296,7 @@ void MAPF_Solver::makeLogBasicInfo(std::ofstream& log)
   log << "lb_makespan=" << getLowerBoundMakespan() << "\n";
   log << "comp_time=" << getCompTime() << "\n";
   log << "preprocessing_comp_time=" << preprocessing_comp_time << "\n";
+  if (Stats::ENABLED) getStats().writeLog(log);
 }
 
 void MAPF_Solver::makeLogSolution(std::ofstream& log)
@@ -255,9 +330,9 @@ void MAPF_Solver::makeLogSolution(std::ofstream& log)
 int MAPF_Solver::pathDist(const int i, Node* const s) const
 {
   if (distance_table_p != nullptr) {
-    return distance_table_p->operator[](i)[s->id];
+    return distance_table_p->operator[](i)->get(s);
   }
-  return distance_table[i][s->id];
+  return distance_table[i]->get(s);
 }
 
 int MAPF_Solver::pathDist(const int i) const
@@ -267,118 +342,54 @@ int MAPF_Solver::pathDist(const int i) const
 
 void MAPF_Solver::createDistanceTable()
 {
+  // agents with the same goal share one table
+  if (distance_cache == nullptr) {
+    distance_cache = std::make_shared<DistanceCache>(G, max_timestep);
+    if (load_distance_cache) loadDistanceCache(distance_cache.get());
+  }
+  distance_table.clear();
   for (int i = 0; i < P->getNum(); ++i) {
-    // breadth first search
-    std::queue<Node*> OPEN;
-    Node* n = P->getGoal(i);
-    OPEN.push(n);
-    distance_table[i][n->id] = 0;
-    while (!OPEN.empty()) {
-      n = OPEN.front();
-      OPEN.pop();
-      const int d_n = distance_table[i][n->id];
-      for (auto m : n->neighbor) {
-        const int d_m = distance_table[i][m->id];
-        if (d_n + 1 >= d_m) continue;
-        distance_table[i][m->id] = d_n + 1;
-        OPEN.push(m);
-      }
-    }
+    distance_table.push_back(distance_cache->get(P->getGoal(i)));
+  }
+  // breadth first search, otherwise expanded when queried
+  if (!lazy_distance_table) completeDistanceTable();
+}
+
+void MAPF_Solver::completeDistanceTable()
+{
+  // BFS is independent for each distinct goal
+  DistanceTables targets;
+  std::vector<bool> added(G->getNodesSize(), false);
+  for (auto& table : getDistanceTables()) {
+    const int id = table->getGoal()->id;
+    if (added[id] || table->completed()) continue;
+    added[id] = true;
+    targets.push_back(table);
   }
+  ThreadPool pool(num_threads);
+  pool.parallelFor(targets.size(), [&](int k) { targets[k]->complete(); });
 }
 
 // -------------------------------
 // utilities for getting path
 // -------------------------------
 MinimumSolver::AstarNode::AstarNode(Node* _v, int _g, int _f, AstarNode* _p)
-    : v(_v), g(_g), f(_f), p(_p), name(getName(_v, _g))
+    : v(_v), g(_g), f(_f), p(_p)
 {
 }
 
-std::string MinimumSolver::AstarNode::getName(Node* _v, int _g)
-{
-  return std::to_string(_v->id) + "-" + std::to_string(_g);
-}
-
 Path MinimumSolver::getPathBySpaceTimeAstar(
     Node* const s, Node* const g, AstarHeuristics& fValue,
     CompareAstarNode& compare, CheckAstarFin& checkAstarFin,
     CheckInvalidAstarNode& checkInvalidAstarNode, const int time_limit)
 {
-  auto t_start = Time::now();
-
-  AstarNodes GC;  // garbage collection
-  auto createNewNode = [&GC](Node* v, int g, int f, AstarNode* p) {
-    AstarNode* new_node = new AstarNode(v, g, f, p);
-    GC.push_back(new_node);
-    return new_node;
-  };
-
-  // OPEN and CLOSE list
-  std::priority_queue<AstarNode*, AstarNodes, CompareAstarNode> OPEN(compare);
-  std::unordered_map<std::string, bool> CLOSE;
-
-  // initial node
-  AstarNode* n = createNewNode(s, 0, 0, nullptr);
-  n->f = fValue(n);
-  OPEN.push(n);
-
-  // main loop
-  bool invalid = true;
-  while (!OPEN.empty()) {
-    // check time limit
-    if (time_limit > 0 && getElapsedTime(t_start) > time_limit) break;
-
-    // minimum node
-    n = OPEN.top();
-    OPEN.pop();
-
-    // check CLOSE list
-    if (CLOSE.find(n->name) != CLOSE.end()) continue;
-    CLOSE[n->name] = true;
-
-    // check goal condition
-    if (checkAstarFin(n)) {
-      invalid = false;
-      break;
-    }
-
-    // expand
-    Nodes C = n->v->neighbor;
-    C.push_back(n->v);
-    for (auto u : C) {
-      int g_cost = n->g + 1;
-      AstarNode* m = createNewNode(u, g_cost, 0, n);
-      m->f = fValue(m);
-      // already searched?
-      if (CLOSE.find(m->name) != CLOSE.end()) continue;
-      // check constraints
-      if (checkInvalidAstarNode(m)) continue;
-      OPEN.push(m);
-    }
-  }
-
-  Path path;
-  if (!invalid) {  // success
-    while (n != nullptr) {
-      path.push_back(n->v);
-      n = n->p;
-    }
-    std::reverse(path.begin(), path.end());
-  }
-
-  // free
-  for (auto p : GC) delete p;
-
-  return path;
+  return getPathBySpaceTimeAstar<AstarHeuristics&, CompareAstarNode&,
+                                 CheckAstarFin&, CheckInvalidAstarNode&>(
+      s, g, fValue, compare, checkAstarFin, checkInvalidAstarNode, time_limit);
 }
 
 MinimumSolver::CompareAstarNode MinimumSolver::compareAstarNodeBasic =
-    [](AstarNode* a, AstarNode* b) {
-      if (a->f != b->f) return a->f > b->f;
-      if (a->g != b->g) return a->g < b->g;
-      return false;
-    };
+    CompareAstarNodeBasic();
 
 Path MAPF_Solver::getPrioritizedPath(
     const int id, const Paths& paths, const int time_limit,
@@ -386,136 +397,32 @@ Path MAPF_Solver::getPrioritizedPath(
     const std::vector<std::tuple<Node*, int>>& constraints,
     CompareAstarNode& compare, const bool manage_path_table)
 {
-  Node* const s = P->getStart(id);
-  Node* const g = P->getGoal(id);
-  const int ideal_dist = pathDist(id);
-  const int makespan = paths.getMakespan();
-
-  // max timestep that another agent uses the goal
-  int max_constraint_time = 0;
-  for (int t = makespan; t >= ideal_dist; --t) {
-    for (int i = 0; i < P->getNum(); ++i) {
-      if (i != id && !paths.empty(i) && paths.get(i, t) == g) {
-        max_constraint_time = t;
-        break;
-      }
-    }
-    if (max_constraint_time > 0) break;
-  }
-
-  // setup functions
-
-  /*
-   * Note: greedy f-value is indeed a good choice but sacrifice completeness.
-   * > return pathDist(id, n->v)
-   * Since prioritized planning itself returns sub-optimal solutions,
-   * the underlying pathfinding is not limited to optimal sub-solution.
-   * c.f., classical f-value: n->g + pathDist(id, n->v)
-   */
-  AstarHeuristics fValue;
-  if (ideal_dist > max_constraint_time) {
-    fValue = [&](AstarNode* n) { return n->g + pathDist(id, n->v); };
-  } else {
-    // when someone occupies its goal
-    fValue = [&](AstarNode* n) {
-      return std::max(max_constraint_time + 1, n->g + pathDist(id, n->v));
-    };
-  }
-
-  CheckAstarFin checkAstarFin = [&](AstarNode* n) {
-    return n->v == g && n->g > max_constraint_time;
-  };
-
-  // update PATH_TABLE
-  if (manage_path_table) updatePathTable(paths, id);
-
-  // fast collision checking
-  CheckInvalidAstarNode checkInvalidAstarNode = [&](AstarNode* m) {
-    if (upper_bound != -1 && m->g > upper_bound) return true;
-
-    if (makespan > 0) {
-      if (m->g > makespan) {
-        if (PATH_TABLE[makespan][m->v->id] != NIL) return true;
-      } else {
-        // vertex conflict
-        if (PATH_TABLE[m->g][m->v->id] != NIL) return true;
-        // swap conflict
-        if (PATH_TABLE[m->g][m->p->v->id] != NIL &&
-            PATH_TABLE[m->g - 1][m->v->id] == PATH_TABLE[m->g][m->p->v->id])
-          return true;
-      }
-    }
-
-    // check additional constraints
-    for (auto c : constraints) {
-      const int t = std::get<1>(c);
-      if (m->v == std::get<0>(c) && (t == -1 || t == m->g)) return true;
-    }
-    return false;
-  };
-
-  auto p = getPathBySpaceTimeAstar(s, g, fValue, compare, checkAstarFin,
-                                   checkInvalidAstarNode, time_limit);
-
-  // clear used path table
-  if (manage_path_table) clearPathTable(paths);
-
-  return p;
+  return getPrioritizedPath<CompareAstarNode&, TieKeyAstarNodeBasic>(
+      id, paths, time_limit, upper_bound, constraints, compare,
+      TieKeyAstarNodeBasic(), manage_path_table);
 }
 
 void MAPF_Solver::updatePathTable(const Paths& paths, const int id)
 {
-  const int makespan = paths.getMakespan();
   const int num_agents = paths.size();
-  const int nodes_size = G->getNodesSize();
-  // extend PATH_TABLE
-  while ((int)PATH_TABLE.size() < makespan + 1)
-    PATH_TABLE.push_back(std::vector<int>(nodes_size, NIL));
-  // update locations
   for (int i = 0; i < num_agents; ++i) {
     if (i == id || paths.empty(i)) continue;
-    auto p = paths.get(i);
-    for (int t = 0; t <= makespan; ++t) PATH_TABLE[t][p[t]->id] = i;
+    PATH_TABLE.insert(i, paths.get(i), 0, true);
   }
 }
 
 void MAPF_Solver::clearPathTable(const Paths& paths)
 {
-  const int makespan = paths.getMakespan();
   const int num_agents = paths.size();
   for (int i = 0; i < num_agents; ++i) {
     if (paths.empty(i)) continue;
-    auto p = paths.get(i);
-    for (int t = 0; t <= makespan; ++t) PATH_TABLE[t][p[t]->id] = NIL;
+    PATH_TABLE.remove(paths.get(i), 0, true);
   }
 }
 
-void MAPF_Solver::updatePathTableWithoutClear(const int id, const Path& p,
-                                              const Paths& paths)
+void MAPF_Solver::updatePathTableWithoutClear(const int id, const Path& p)
 {
-  if (p.empty()) return;
-
-  const int makespan = PATH_TABLE.size() - 1;
-  const int nodes_size = G->getNodesSize();
-  const int p_makespan = p.size() - 1;
-
-  // extend PATH_TABLE
-  if (p_makespan > makespan) {
-    while ((int)PATH_TABLE.size() < p_makespan + 1)
-      PATH_TABLE.push_back(std::vector<int>(nodes_size, NIL));
-    for (int i = 0; i < P->getNum(); ++i) {
-      if (paths.empty(i)) continue;
-      auto v_id = paths.get(i, makespan)->id;
-      for (int t = makespan + 1; t <= p_makespan; ++t) PATH_TABLE[t][v_id] = i;
-    }
-  }
-
-  // register new path
-  for (int t = 0; t <= p_makespan; ++t) PATH_TABLE[t][p[t]->id] = id;
-  if (makespan > p_makespan) {
-    auto v_id = p[p_makespan]->id;
-    for (int t = p_makespan + 1; t <= makespan; ++t) PATH_TABLE[t][v_id] = id;
-  }
+  PATH_TABLE.insert(id, p, 0, true);
 }
 
 //-----------------------------------------------------
@@ -523,62 +430,108 @@ void MAPF_Solver::updatePathTableWithoutClear(const int id, const Path& p,
 MAPD_Solver::MAPD_Solver(MAPD_Instance* _P, bool _use_distance_table)
     : MinimumSolver(_P),
       P(_P),
+      hist_offset(0),
+      stream_chunk(0),
+      stream_drop(false),
+      streamed(0),
+      streamed_chunk(0),
       use_distance_table(_use_distance_table),
       preprocessing_comp_time(0),
-      distance_table(G->getNodesSize(),
-                     std::vector<int>(G->getNodesSize(), G->getNodesSize()))
+      distance_cache(std::make_shared<DistanceCache>(G, G->getNodesSize()))
 {
 }
 
-MAPD_Solver::~MAPD_Solver() {}
+MAPD_Solver::~MAPD_Solver()
+{
+  if (!stream_file.empty()) std::remove(stream_file.c_str());
+}
 
 void MAPD_Solver::solve()
 {
   // create distance table
-  if (use_distance_table) {
-    auto t_s = Time::now();
-    info("  pre-processing, create distance table by Floyd-Warshall");
-    createDistanceTable();
-    preprocessing_comp_time = getElapsedTime(t_s);
-    info("  done, elapsed: ", preprocessing_comp_time);
+  auto t_s = Time::now();
+  {
+    auto timer = stats.timer(Stats::DISTANCE_TABLE);
+    if (load_distance_cache) loadDistanceCache(distance_cache.get());
+    if (use_distance_table) {
+      info("  pre-processing, create distance table by BFS from endpoints");
+      createDistanceTable();
+      info("  done, elapsed: ", getElapsedTime(t_s));
+    }
   }
+  preprocessing_comp_time = getElapsedTime(t_s);
 
   start();
   exec();
   end();
+
+  // write remaining lines
+  if (!stream_file.empty()) {
+    streamPlan(true);
+    stream.close();
+  }
 }
 
 void MAPD_Solver::exec() { run(); }
 
-int MAPD_Solver::pathDist(Node* const s, Node* const g) const
+void MAPD_Solver::updateHistory(const Nodes& targets, const Tasks& tasks)
 {
-  if (use_distance_table) return distance_table[s->id][g->id];
-  return G->pathDist(s, g);
+  hist_targets.push_back(targets);
+  hist_tasks.push_back(tasks);
+  if (!stream_file.empty()) streamPlan();
 }
 
-void MAPD_Solver::createDistanceTable()
+void MAPD_Solver::setPlanStream(const std::string& _file, const int _chunk,
+                                const bool _drop)
 {
-  const int nodes_num = G->getNodesSize();
-  for (int i = 0; i < nodes_num; ++i) {
-    auto u = G->getNode(i);
-    if (u == nullptr) continue;
-    for (auto v : u->neighbor) {
-      distance_table[i][v->id] = 1;
-    }
-    distance_table[i][i] = 0;
-  }
+  if (_chunk <= 0) halt("chunk of streaming plan must be positive");
+  stream_file = _file;
+  stream_chunk = _chunk;
+  stream_drop = _drop;
+  stream.open(stream_file, std::ios::out);
+  if (!stream) halt("failed to open " + stream_file);
+}
 
-  // main loop
-  for (int k = 0; k < nodes_num; ++k) {
-    for (int i = 0; i < nodes_num; ++i) {
-      for (int j = 0; j < nodes_num; ++j) {
-        distance_table[i][j] = std::min(
-            distance_table[i][j], distance_table[i][k] + distance_table[k][j]);
-      }
-    }
+void MAPD_Solver::streamPlan(const bool force)
+{
+  auto timer = stats.timer(Stats::LOGGING);
+  // a timestep is complete when both its configuration and history exist
+  const int available =
+      std::min(solution.size(), hist_offset + (int)hist_targets.size());
+  for (; streamed < available; ++streamed, ++streamed_chunk) {
+    makeLogTimestep(stream_buffer, streamed);
+  }
+  if (streamed_chunk < stream_chunk && !(force && streamed_chunk > 0)) return;
+
+  // write the chunk
+  stream << stream_buffer.str();
+  stream_buffer.str("");
+  streamed_chunk = 0;
+  if (!stream_drop) return;
+
+  // keep the last timestep as the window
+  solution.drop(streamed - 1);
+  while (hist_offset < streamed - 1) {
+    hist_targets.pop_front();
+    hist_tasks.pop_front();
+    ++hist_offset;
   }
 }
 
+int MAPD_Solver::pathDist(Node* const s, Node* const g) const
+{
+  return distance_cache->pathDist(s, g);
+}
+
+void MAPD_Solver::createDistanceTable()
+{
+  // BFS is independent for each endpoint, others are computed on demand
+  Nodes goals = P->getPickupLocs();
+  for (auto v : P->getDeliveryLocs()) goals.push_back(v);
+  for (auto v : P->getEndpoints()) goals.push_back(v);
+  distance_cache->complete(goals, num_threads);
+}
+
 float MAPD_Solver::getTotalServiceTime()
 {
   if (!solved) return false;
@@ -606,6 +559,7 @@ void MAPD_Solver::printResult()
 
 void MAPD_Solver::makeLog(const std::string& logfile)
 {
+  auto timer = stats.timer(Stats::LOGGING);
   std::ofstream log;
   log.open(logfile, std::ios::out);
   makeLogBasicInfo(log);
@@ -613,7 +567,48 @@ void MAPD_Solver::makeLog(const std::string& logfile)
   log.close();
 }
 
-void MAPD_Solver::makeLogBasicInfo(std::ofstream& log)
+void MAPD_Solver::makeLogBinary(const std::string& logfile)
+{
+  auto timer = stats.timer(Stats::LOGGING);
+  BinaryLog bin;
+  bin.kind = BinaryLog::MAPD;
+  std::ostringstream header;
+  makeLogBasicInfo(header);
+  bin.header = header.str();
+  bin.has_solution = !log_short;
+  if (bin.has_solution) {
+    if (solution.getOffset() > 0 || hist_offset > 0) {
+      halt("binary log requires the whole plan, disable streaming");
+    }
+    const int num_agents = P->getNum();
+    const int num_timesteps = solution.size();
+    bin.width = reinterpret_cast<Grid*>(G)->getWidth();
+    bin.num_agents = num_agents;
+    bin.num_timesteps = num_timesteps;
+    for (int i = 0; i < num_agents; ++i) {
+      bin.starts.push_back(P->getStart(i)->id);
+    }
+    for (auto task : P->getClosedTasks()) {
+      bin.tasks.push_back({task->id, task->loc_pickup->id,
+                           task->loc_delivery->id, task->timestep_appear,
+                           task->timestep_finished});
+    }
+    bin.paths.assign(num_agents, std::vector<int>(num_timesteps));
+    bin.targets.assign(num_agents, std::vector<int>(num_timesteps));
+    bin.task_ids.assign(num_agents, std::vector<int>(num_timesteps));
+    for (int t = 0; t < num_timesteps; ++t) {
+      for (int i = 0; i < num_agents; ++i) {
+        auto task = hist_tasks[t][i];
+        bin.paths[i][t] = solution.get(t, i)->id;
+        bin.targets[i][t] = hist_targets[t][i]->id;
+        bin.task_ids[i][t] = (task == nullptr) ? Task::NIL : task->id;
+      }
+    }
+  }
+  if (!bin.write(logfile)) halt("failed to write " + logfile);
+}
+
+void MAPD_Solver::makeLogBasicInfo(std::ostream& log)
 {
   Grid* grid = reinterpret_cast<Grid*>(P->getG());
   log << "instance=" << P->getInstanceFileName() << "\n";
@@ -625,6 +620,7 @@ void MAPD_Solver::makeLogBasicInfo(std::ofstream& log)
   log << "makespan=" << solution.getMakespan() << "\n";
   log << "comp_time=" << getCompTime() << "\n";
   log << "preprocessing_comp_time=" << preprocessing_comp_time << "\n";
+  if (Stats::ENABLED) getStats().writeLog(log);
 }
 
 void MAPD_Solver::makeLogSolution(std::ofstream& log)
@@ -645,17 +641,26 @@ void MAPD_Solver::makeLogSolution(std::ofstream& log)
         << "finished=" << task->timestep_finished << "\n";
   }
   log << "solution=\n";
-  for (int t = 0; t <= solution.getMakespan(); ++t) {
-    log << t << ":";
-    auto c = solution.get(t);
-    for (int i = 0; i < (int)P->getNum(); ++i) {
-      auto v = c[i];
-      auto u = hist_targets[t][i];
-      auto task = hist_tasks[t][i];
-      log << "(" << v->pos.x << "," << v->pos.y << ")->"
-          << "(" << u->pos.x << "," << u->pos.y
-          << "):" << ((task == nullptr) ? Task::NIL : task->id) << ",";
-    }
-    log << "\n";
+  if (!stream_file.empty()) {
+    // already formatted
+    std::ifstream spool(stream_file);
+    log << spool.rdbuf();
+    return;
   }
+  for (int t = 0; t <= solution.getMakespan(); ++t) makeLogTimestep(log, t);
+}
+
+void MAPD_Solver::makeLogTimestep(std::ostream& log, const int t) const
+{
+  log << t << ":";
+  auto c = solution.get(t);
+  for (int i = 0; i < (int)P->getNum(); ++i) {
+    auto v = c[i];
+    auto u = hist_targets[t - hist_offset][i];
+    auto task = hist_tasks[t - hist_offset][i];
+    log << "(" << v->pos.x << "," << v->pos.y << ")->"
+        << "(" << u->pos.x << "," << u->pos.y
+        << "):" << ((task == nullptr) ? Task::NIL : task->id) << ",";
+  }
+  log << "\n";
 }
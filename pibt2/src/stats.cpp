@@ -0,0 +1,79 @@
+#include "../include/stats.hpp"
+
+void Stats::merge(const Stats& other)
+{
+  for (int p = 0; p < NUM_PHASES; ++p) times[p] += other.times[p];
+  for (int c = 0; c < NUM_COUNTERS; ++c) {
+    if (c == MAX_INHERITANCE_DEPTH) {
+      countMax((Counter)c, other.counts[c]);
+    } else {
+      counts[c] += other.counts[c];
+    }
+  }
+}
+
+const char* Stats::getName(const Phase phase)
+{
+  switch (phase) {
+    case DISTANCE_TABLE:
+      return "distance_table";
+    case ASSIGNMENT:
+      return "assignment";
+    case PLANNING:
+      return "planning";
+    case ACTING:
+      return "acting";
+    case LOGGING:
+      return "logging";
+    default:
+      return "";
+  }
+}
+
+const char* Stats::getName(const Counter counter)
+{
+  switch (counter) {
+    case INHERITANCES:
+      return "inheritances";
+    case MAX_INHERITANCE_DEPTH:
+      return "max_inheritance_depth";
+    case BACKTRACKS:
+      return "backtracks";
+    case ASTAR_EXPANDED:
+      return "astar_expanded";
+    case ASTAR_GENERATED:
+      return "astar_generated";
+    case RESERVATIONS:
+      return "reservations";
+    default:
+      return "";
+  }
+}
+
+void Stats::writeLog(std::ostream& log) const
+{
+  // except logging, which is not finished while writing the log
+  for (int p = 0; p < NUM_PHASES; ++p) {
+    if (p == LOGGING) continue;
+    log << "stats_" << getName((Phase)p) << "_ns=" << times[p] << "\n";
+  }
+  for (int c = 0; c < NUM_COUNTERS; ++c) {
+    log << "stats_" << getName((Counter)c) << "=" << counts[c] << "\n";
+  }
+}
+
+void Stats::writeJSON(std::ostream& log) const
+{
+  log << "{\"enabled\": " << (ENABLED ? "true" : "false");
+  log << ", \"time_ns\": {";
+  for (int p = 0; p < NUM_PHASES; ++p) {
+    log << (p > 0 ? ", " : "") << "\"" << getName((Phase)p)
+        << "\": " << times[p];
+  }
+  log << "}, \"counters\": {";
+  for (int c = 0; c < NUM_COUNTERS; ++c) {
+    log << (c > 0 ? ", " : "") << "\"" << getName((Counter)c)
+        << "\": " << counts[c];
+  }
+  log << "}}";
+}
@@ -0,0 +1,79 @@
+#include "../include/thread_pool.hpp"
+
+#include <atomic>
+
+ThreadPool::ThreadPool(int num_threads) : num_unfinished(0), stop(false)
+{
+  if (num_threads <= 0) num_threads = std::thread::hardware_concurrency();
+  if (num_threads <= 1) return;
+  for (int i = 0; i < num_threads; ++i) {
+    workers.emplace_back([this] { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop = true;
+  }
+  cv_task.notify_all();
+  for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::work()
+{
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv_task.wait(lock, [this] { return stop || !tasks.empty(); });
+      if (stop && tasks.empty()) return;
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (--num_unfinished == 0) cv_done.notify_all();
+    }
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+  // single thread
+  if (workers.empty()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    tasks.push(std::move(task));
+    ++num_unfinished;
+  }
+  cv_task.notify_one();
+}
+
+void ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  cv_done.wait(lock, [this] { return num_unfinished == 0; });
+}
+
+void ThreadPool::parallelFor(const int n, const std::function<void(int)>& f)
+{
+  if (workers.empty()) {
+    for (int i = 0; i < n; ++i) f(i);
+    return;
+  }
+  // each worker takes the next index, balancing uneven workloads
+  std::atomic<int> next(0);
+  const int num_tasks = std::min(n, (int)workers.size());
+  for (int k = 0; k < num_tasks; ++k) {
+    submit([&] {
+      for (int i = next++; i < n; i = next++) f(i);
+    });
+  }
+  wait();
+}
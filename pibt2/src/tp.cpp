@@ -3,7 +3,7 @@
 const std::string TP::SOLVER_NAME = "TP";
 
 TP::TP(MAPD_Instance* _P, bool _use_distance_table)
-    : MAPD_Solver(_P, _use_distance_table)
+    : MAPD_Solver(_P, _use_distance_table), CONFLICT_TABLE(G->getNodesSize())
 {
   solver_name = TP::SOLVER_NAME;
 }
@@ -13,11 +13,6 @@ void TP::run()
   std::vector<Path> TOKEN(P->getNum());
   Agents A;
 
-  // initialize conflict table
-  {
-    CONFLICT_TABLE.push_back(std::vector<int>(G->getNodesSize(), NIL));
-  }
-
   for (int i = 0; i < P->getNum(); ++i) {
     Node* s = P->getStart(i);
     Agent* a = new Agent{
@@ -63,15 +58,18 @@ void TP::run()
 
       // line 7, pickup assignable tasks
       Tasks selected_tasks;
-      for (auto task : unassigned_tasks) {
-        if (task->assigned) continue;  // line 11
-
-        bool cond = std::all_of(A.begin(), A.end(), [&](Agent* b) {
-          if (b == a) return true;
-          auto v = *(TOKEN[b->id].end() - 1);
-          return v != task->loc_pickup && v != task->loc_delivery;
-        });
-        if (cond) selected_tasks.push_back(task);
+      {
+        auto timer = stats.timer(Stats::ASSIGNMENT);
+        for (auto task : unassigned_tasks) {
+          if (task->assigned) continue;  // line 11
+
+          bool cond = std::all_of(A.begin(), A.end(), [&](Agent* b) {
+            if (b == a) return true;
+            auto v = *(TOKEN[b->id].end() - 1);
+            return v != task->loc_pickup && v != task->loc_delivery;
+          });
+          if (cond) selected_tasks.push_back(task);
+        }
       }
 
       if (!selected_tasks.empty()) {  // line 8
@@ -105,12 +103,7 @@ void TP::run()
         TOKEN[a->id].push_back(a->v_now);
 
         // update conflict table
-        {
-          while (CONFLICT_TABLE.size() - 1 < TOKEN[a->id].size() - 1) {
-            CONFLICT_TABLE.push_back(std::vector<int>(G->getNodesSize(), NIL));
-          }
-          CONFLICT_TABLE[P->getCurrentTimestep() + 1][a->v_now->id] = a->id;
-        }
+        CONFLICT_TABLE.reserve(P->getCurrentTimestep() + 1, a->v_now, a->id);
 
         targets[a->id] = a->v_now;
 
@@ -123,9 +116,9 @@ void TP::run()
       }
     }
 
-    hist_targets.push_back(targets);
-    hist_tasks.push_back(tasks);
+    updateHistory(targets, tasks);
 
+    auto timer = stats.timer(Stats::ACTING);
     Config config(P->getNum(), nullptr);
     for (auto a : A) {
       auto v_next = TOKEN[a->id][P->getCurrentTimestep() + 1];
@@ -185,14 +178,20 @@ void TP::run()
       targets.push_back(*(TOKEN[a->id].end() - 1));
       tasks.push_back(a->task);
     }
-    hist_targets.push_back(targets);
-    hist_tasks.push_back(tasks);
+    updateHistory(targets, tasks);
   }
 
   // memory clear
   for (auto a : A) delete a;
 }
 
+Stats TP::getStats() const
+{
+  Stats s = MAPD_Solver::getStats();
+  s.merge(CONFLICT_TABLE.getStats());
+  return s;
+}
+
 void TP::updatePath1(int i, Task* task, std::vector<Path>& TOKEN)
 {
   info("   ", "updatePath1, agent-", i);
@@ -249,6 +248,7 @@ void TP::updatePath2(int i, std::vector<Path>& TOKEN, Tasks& unassigned_tasks)
 
 void TP::updatePath(int i, Node* g, std::vector<Path>& TOKEN)
 {
+  auto timer = stats.timer(Stats::PLANNING);
   auto s = *(TOKEN[i].end() - 1);
   const int current_timestep = (int)TOKEN[i].size() - 1;
 
@@ -263,56 +263,51 @@ void TP::updatePath(int i, Node* g, std::vector<Path>& TOKEN)
     }
   }
 
-  AstarHeuristics fValue = [&](AstarNode* n) {
-    return n->g + pathDist(n->v, g);
-  };
+  auto fValue = [&](AstarNode* n) { return n->g + pathDist(n->v, g); };
 
-  CheckAstarFin checkAstarFin = [&](AstarNode* n) {
+  auto checkAstarFin = [&](AstarNode* n) {
     return n->v == g && n->g + current_timestep > max_constraint_time;
   };
 
-  std::vector<int> token_endpoints(G->getNodesSize(), NIL);
+  // reused among calls, restored after the search
+  if (token_endpoints.empty()) token_endpoints.assign(G->getNodesSize(), NIL);
   for (int j = 0; j < P->getNum(); ++j) {
     if (j == i) continue;
     token_endpoints[(*(TOKEN[j].end() - 1))->id] = j;
   }
 
-  CheckInvalidAstarNode checkInvalidAstarNode = [&](AstarNode* m) {
+  auto checkInvalidAstarNode = [&](AstarNode* m) {
     auto t = current_timestep + m->g;
     // avoid endpoints
     auto k = token_endpoints[m->v->id];
     if (k != NIL && (int)TOKEN[k].size() - 1 < t) return true;
-    // avoid conflicts
-    if ((int)CONFLICT_TABLE.size() - 1 >= t) {
-      // check vertex conflicts
-      if (CONFLICT_TABLE[t][m->v->id] != NIL) return true;
-      // check swap conflicts
-      if (CONFLICT_TABLE[t][m->p->v->id] != NIL &&
-          CONFLICT_TABLE[t - 1][m->v->id] == CONFLICT_TABLE[t][m->p->v->id])
-        return true;
-    }
+    // check vertex conflicts
+    if (CONFLICT_TABLE.isReserved(t, m->v)) return true;
+    // check swap conflicts
+    const int j = CONFLICT_TABLE.getAgent(t, m->p->v);
+    if (j != NIL && CONFLICT_TABLE.getAgent(t - 1, m->v) == j) return true;
 
     return false;
   };
 
   // get path
-  auto path = getPathBySpaceTimeAstar(s, g, fValue, compareAstarNodeBasic,
-                                      checkAstarFin, checkInvalidAstarNode,
-                                      getRemainedTime());
-
-  if (path.empty()) halt("failed");
+  auto path = getPathBySpaceTimeAstar(
+      s, g, astar_workspace, use_bucket_queue, fValue, CompareAstarNodeBasic(),
+      TieKeyAstarNodeBasic(), checkAstarFin, checkInvalidAstarNode,
+      getRemainedTime());
 
-  // update conflict table
-  while (CONFLICT_TABLE.size() - 1 < current_timestep + path.size() - 1) {
-    CONFLICT_TABLE.push_back(std::vector<int>(G->getNodesSize(), NIL));
+  for (int j = 0; j < P->getNum(); ++j) {
+    token_endpoints[(*(TOKEN[j].end() - 1))->id] = NIL;
   }
 
+  if (path.empty()) halt("failed");
+
   // update TOKEN
   for (int _t = 1; _t < (int)path.size(); ++_t) {
     TOKEN[i].push_back(path[_t]);
 
     // update conflict table
-    CONFLICT_TABLE[current_timestep + _t][path[_t]->id] = i;
+    CONFLICT_TABLE.reserve(current_timestep + _t, path[_t], i);
   }
 }
 
@@ -0,0 +1,81 @@
+#include <binary_log.hpp>
+#include <filesystem>
+#include <fstream>
+#include <pibt.hpp>
+#include <pibt_mapd.hpp>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+static std::string readFile(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+static const std::string TEXT_LOG =
+    (std::filesystem::temp_directory_path() / "test_binary_log.txt").string();
+static const std::string BINARY_LOG =
+    (std::filesystem::temp_directory_path() / "test_binary_log.bin").string();
+
+// the text restored from the binary log is the same as the text log
+template <typename Solver>
+static void checkRestore(Solver& solver)
+{
+  solver.makeLog(TEXT_LOG);
+  solver.makeLogBinary(BINARY_LOG);
+  BinaryLog bin;
+  ASSERT_TRUE(bin.read(BINARY_LOG));
+  std::ostringstream restored;
+  bin.writeText(restored);
+  ASSERT_EQ(restored.str(), readFile(TEXT_LOG));
+  std::filesystem::remove(TEXT_LOG);
+  std::filesystem::remove(BINARY_LOG);
+}
+
+TEST(BinaryLog, MAPF)
+{
+  auto P = MAPF_Instance("../tests/instances/dense.txt");
+  PIBT solver(&P);
+  solver.solve();
+  checkRestore(solver);
+
+  solver.setLogShort(true);
+  checkRestore(solver);
+}
+
+TEST(BinaryLog, MAPD)
+{
+  auto P = MAPD_Instance("../tests/instances/dense_mapd.txt");
+  PIBT_MAPD solver(&P);
+  solver.solve();
+  checkRestore(solver);
+}
+
+TEST(BinaryLog, invalid)
+{
+  auto P = MAPF_Instance("../tests/instances/example.txt");
+  PIBT solver(&P);
+  solver.solve();
+  solver.makeLogBinary(BINARY_LOG);
+  auto data = readFile(BINARY_LOG);
+
+  // truncated
+  {
+    std::ofstream file(BINARY_LOG, std::ios::out | std::ios::binary);
+    file.write(data.data(), data.size() - 1);
+  }
+  BinaryLog bin;
+  ASSERT_FALSE(bin.read(BINARY_LOG));
+
+  // broken magic
+  data[0] = 'X';
+  {
+    std::ofstream file(BINARY_LOG, std::ios::out | std::ios::binary);
+    file.write(data.data(), data.size());
+  }
+  ASSERT_FALSE(bin.read(BINARY_LOG));
+  std::filesystem::remove(BINARY_LOG);
+}
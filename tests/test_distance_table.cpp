@@ -0,0 +1,128 @@
+#include <distance_table.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(DistanceTable, basic)
+{
+  Grid G("8x8.map");
+  Node* g = G.getNode(0);
+  DistanceTable table(&G, g, G.getNodesSize());
+
+  ASSERT_EQ(table.get(g), 0);
+  for (auto v : g->neighbor) ASSERT_EQ(table.get(v), 1);
+  ASSERT_EQ(table.get(G.getNode(7, 7)), 14);
+  ASSERT_FALSE(table.completed());
+
+  table.complete();
+  ASSERT_TRUE(table.completed());
+  ASSERT_EQ(table.get(G.getNode(7, 0)), 7);
+}
+
+TEST(DistanceTable, lazy)
+{
+  Grid G("random-32-32-20.map");
+  Node* g = G.getV()[0];
+  DistanceTable eager(&G, g, G.getNodesSize());
+  DistanceTable lazy(&G, g, G.getNodesSize());
+  eager.complete();
+
+  // query in reverse order
+  Nodes V = G.getV();
+  for (auto itr = V.rbegin(); itr != V.rend(); ++itr) {
+    ASSERT_EQ(lazy.get(*itr), eager.get(*itr));
+  }
+}
+
+TEST(DistanceTable, maxDist)
+{
+  Grid G("8x8.map");
+  DistanceTable table(&G, G.getNode(0), 5);
+  ASSERT_EQ(table.get(G.getNode(4, 0)), 4);
+  ASSERT_EQ(table.get(G.getNode(5, 0)), 5);
+  ASSERT_EQ(table.get(G.getNode(7, 7)), 5);
+}
+
+TEST(DistanceTable, moves)
+{
+  Grid G("random-32-32-20.map");
+  DistanceTable table(&G, G.getV()[0], 30);
+  table.initMoves();
+
+  for (auto v : G.getV()) {
+    const uint8_t moves = table.getMoves(v);
+    ASSERT_NE(moves, DistanceTable::MOVES_NIL);
+    ASSERT_EQ(table.getMoves(v), moves);
+    for (int k = 0; k < v->getDegree(); ++k) {
+      const int key = DistanceTable::getMoveKey(moves, k);
+      ASSERT_EQ(key, table.get(v->neighbor[k]) - table.get(v) + 1);
+    }
+  }
+}
+
+TEST(DistanceCache, share)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(7, 7);
+  DistanceCache cache(&G, G.getNodesSize());
+
+  auto table1 = cache.get(v);
+  auto table2 = cache.get(v);
+  ASSERT_EQ(table1, table2);
+  ASSERT_EQ(cache.size(), 1);
+
+  ASSERT_EQ(cache.pathDist(u, v), 14);
+  ASSERT_EQ(cache.pathDist(v, u), 14);
+  ASSERT_EQ(cache.size(), 2);
+
+  // only the table referenced by agents remains
+  cache.release();
+  ASSERT_EQ(cache.size(), 1);
+  ASSERT_EQ(cache.get(v), table1);
+}
+
+TEST(DistanceCache, complete)
+{
+  Grid G("random-32-32-20.map");
+  Nodes V = G.getV();
+  Nodes goals(V.begin(), V.begin() + 10);
+  goals.push_back(V[0]);  // duplicated
+  DistanceCache cache(&G, G.getNodesSize());
+  cache.complete(goals, 4);
+  ASSERT_EQ(cache.size(), 10);
+
+  for (auto g : goals) {
+    ASSERT_TRUE(cache.get(g)->completed());
+    DistanceTable table(&G, g, G.getNodesSize());
+    for (auto v : V) ASSERT_EQ(cache.pathDist(v, g), table.get(v));
+  }
+}
+
+TEST(DistanceCache, saveAndLoad)
+{
+  Grid G("random-32-32-20.map");
+  Nodes V = G.getV();
+  Nodes goals(V.begin(), V.begin() + 5);
+  const std::string filename = "./test_distance_cache.dist";
+
+  DistanceCache cache1(&G, 100);
+  cache1.complete(goals);
+  cache1.get(V[5]);  // not completed, not stored
+  cache1.save(filename);
+
+  DistanceCache cache2(&G, 50);
+  ASSERT_TRUE(cache2.load(filename));
+  ASSERT_EQ(cache2.size(), 5);
+  DistanceCache cache3(&G, 50);
+  for (auto g : goals) {
+    ASSERT_TRUE(cache2.get(g)->completed());
+    for (auto v : V) ASSERT_EQ(cache2.pathDist(v, g), cache3.pathDist(v, g));
+  }
+
+  // distances in the file are capped
+  DistanceCache cache4(&G, 200);
+  ASSERT_FALSE(cache4.load(filename));
+
+  std::remove(filename.c_str());
+  ASSERT_FALSE(cache4.load(filename));
+}
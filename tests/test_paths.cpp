@@ -1,3 +1,4 @@
+#include <numeric>
 #include <paths.hpp>
 
 #include "gtest/gtest.h"
@@ -98,3 +99,75 @@ TEST(Paths, conflict)
   paths4.insert(2, {w, w, w});
   ASSERT_EQ(paths4.countConflict(2, {w, w, u}), 1);
 }
+
+TEST(Paths, conflictRandom)
+{
+  Grid G("8x8.map");
+  std::mt19937 MT(0);
+  const int num_agents = 20;
+
+  // random walks, crowded enough to have vertex and swap conflicts
+  auto randomWalk = [&](Node* s, const int len) {
+    Path path = {s};
+    for (int t = 1; t < len; ++t) {
+      Nodes C = path.back()->neighbor;
+      C.push_back(path.back());
+      path.push_back(randomChoose(C, &MT));
+    }
+    return path;
+  };
+  Paths paths(num_agents);
+  for (int i = 0; i < num_agents; ++i) {
+    paths.insert(i, randomWalk(G.getNode(i), 10 + i));
+  }
+
+  // pairwise definitions
+  const int makespan = paths.getMakespan();
+  auto countPairs = [&](const std::vector<int>& sample) {
+    int cnt = 0;
+    for (int k = 0; k < (int)sample.size(); ++k) {
+      for (int l = k + 1; l < (int)sample.size(); ++l) {
+        for (int t = 1; t <= makespan; ++t) {
+          if (paths.conflicted(sample[k], sample[l], t)) ++cnt;
+        }
+      }
+    }
+    return cnt;
+  };
+  std::vector<int> all(num_agents);
+  std::iota(all.begin(), all.end(), 0);
+  const int cnt = countPairs(all);
+  ASSERT_GT(cnt, 0);
+  ASSERT_EQ(paths.countConflict(), cnt);
+  const std::vector<int> sample = {3, 17, 5, 11, 0, 8};
+  ASSERT_EQ(paths.countConflict(sample), countPairs(sample));
+
+  for (int len : {1, 5, makespan + 1, makespan + 20}) {
+    const Path path = randomWalk(G.getNode(30), len);
+    for (int id : {0, 7, -1}) {
+      int expected = 0;
+      for (int i = 0; i < num_agents; ++i) {
+        if (i == id) continue;
+        for (int t = 1; t < len; ++t) {
+          if (t > makespan) {
+            if (path[t] == paths.last(i)) {
+              ++expected;
+              break;
+            }
+            continue;
+          }
+          if (paths.get(i, t) == path[t] ||
+              (paths.get(i, t) == path[t - 1] &&
+               paths.get(i, t - 1) == path[t])) {
+            ++expected;
+          }
+        }
+      }
+      ASSERT_EQ(paths.countConflict(id, path), expected);
+    }
+  }
+
+  // ids follow updates of paths
+  paths.insert(4, Path(makespan + 1, G.getNode(30)));
+  ASSERT_EQ(paths.countConflict(), countPairs(all));
+}
@@ -11,3 +11,156 @@ TEST(PIBT, solve)
   ASSERT_TRUE(solver->succeed());
   ASSERT_TRUE(solver->getSolution().validate(&P));
 }
+
+TEST(PIBT, iterative_inheritance)
+{
+  // the same solution as the recursive version, same seed
+  // graphs differ, compare node ids
+  auto P1 = MAPF_Instance("../tests/instances/dense.txt");
+  auto P2 = MAPF_Instance("../tests/instances/dense.txt");
+  auto solver1 = std::make_unique<PIBT>(&P1);
+  auto solver2 = std::make_unique<PIBT>(&P2);
+  solver1->setRecursiveInheritance(true);
+  solver1->solve();
+  solver2->solve();
+
+  auto plan1 = solver1->getSolution();
+  auto plan2 = solver2->getSolution();
+  ASSERT_EQ(plan1.getMakespan(), plan2.getMakespan());
+  for (int t = 0; t <= plan1.getMakespan(); ++t) {
+    for (int i = 0; i < P1.getNum(); ++i) {
+      ASSERT_EQ(plan1.get(t, i)->id, plan2.get(t, i)->id);
+    }
+  }
+}
+
+TEST(PIBT, parallel)
+{
+  auto P = MAPF_Instance("../tests/instances/example.txt");
+  auto solver = std::make_unique<PIBT>(&P);
+  solver->setParallel(true);
+  solver->setNumThreads(4);
+  solver->solve();
+  ASSERT_TRUE(solver->succeed());
+  ASSERT_TRUE(solver->getSolution().validate(&P));
+
+  // independent of the number of threads
+  auto P1 = MAPF_Instance("../tests/instances/dense.txt");
+  auto P2 = MAPF_Instance("../tests/instances/dense.txt");
+  auto solver1 = std::make_unique<PIBT>(&P1);
+  auto solver2 = std::make_unique<PIBT>(&P2);
+  solver1->setParallel(true);
+  solver2->setParallel(true);
+  solver2->setNumThreads(4);
+  solver1->solve();
+  solver2->solve();
+
+  auto plan1 = solver1->getSolution();
+  auto plan2 = solver2->getSolution();
+  ASSERT_EQ(plan1.getMakespan(), plan2.getMakespan());
+  for (int t = 0; t <= plan1.getMakespan(); ++t) {
+    for (int i = 0; i < P1.getNum(); ++i) {
+      ASSERT_EQ(plan1.get(t, i)->id, plan2.get(t, i)->id);
+    }
+  }
+}
+
+TEST(PIBT, parallel_distance_table)
+{
+  // BFS in parallel, the same solution
+  auto P1 = MAPF_Instance("../tests/instances/dense.txt");
+  auto P2 = MAPF_Instance("../tests/instances/dense.txt");
+  auto solver1 = std::make_unique<PIBT>(&P1);
+  auto solver2 = std::make_unique<PIBT>(&P2);
+  solver2->setNumThreads(4);
+  solver1->solve();
+  solver2->solve();
+
+  auto plan1 = solver1->getSolution();
+  auto plan2 = solver2->getSolution();
+  ASSERT_EQ(plan1.getMakespan(), plan2.getMakespan());
+  for (int t = 0; t <= plan1.getMakespan(); ++t) {
+    for (int i = 0; i < P1.getNum(); ++i) {
+      ASSERT_EQ(plan1.get(t, i)->id, plan2.get(t, i)->id);
+    }
+  }
+}
+
+TEST(PIBT, move_table)
+{
+  // the same solution as ordering by distances
+  auto P1 = MAPF_Instance("../tests/instances/dense.txt");
+  auto P2 = MAPF_Instance("../tests/instances/dense.txt");
+  auto solver1 = std::make_unique<PIBT>(&P1);
+  auto solver2 = std::make_unique<PIBT>(&P2);
+  solver2->setMoveTable(true);
+  solver1->solve();
+  solver2->solve();
+
+  auto plan1 = solver1->getSolution();
+  auto plan2 = solver2->getSolution();
+  ASSERT_EQ(plan1.getMakespan(), plan2.getMakespan());
+  for (int t = 0; t <= plan1.getMakespan(); ++t) {
+    for (int i = 0; i < P1.getNum(); ++i) {
+      ASSERT_EQ(plan1.get(t, i)->id, plan2.get(t, i)->id);
+    }
+  }
+}
+
+TEST(PIBT, compact_plan)
+{
+  auto P1 = MAPF_Instance("../tests/instances/dense.txt");
+  auto P2 = MAPF_Instance("../tests/instances/dense.txt");
+  auto solver1 = std::make_unique<PIBT>(&P1);
+  auto solver2 = std::make_unique<PIBT>(&P2);
+  solver2->setCompactPlan(true);
+  solver1->solve();
+  solver2->solve();
+
+  auto plan1 = solver1->getSolution();
+  auto plan2 = solver2->getSolution();
+  ASSERT_TRUE(plan2.isCompact());
+  ASSERT_EQ(plan1.getMakespan(), plan2.getMakespan());
+  ASSERT_EQ(plan1.getSOC(), plan2.getSOC());
+  for (int t = 0; t <= plan1.getMakespan(); ++t) {
+    for (int i = 0; i < P1.getNum(); ++i) {
+      ASSERT_EQ(plan1.get(t, i)->id, plan2.get(t, i)->id);
+    }
+  }
+}
+
+TEST(PIBT, shared_distance_cache)
+{
+  // solvers in parallel read one completed cache
+  auto P = MAPF_Instance("../tests/instances/dense.txt");
+  std::vector<std::unique_ptr<MAPF_Instance>> instances;
+  for (int k = 0; k < 4; ++k) {
+    auto load_map = [&](const std::string&) { return P.getG(); };
+    instances.push_back(std::make_unique<MAPF_Instance>(
+        "../tests/instances/dense.txt", load_map));
+  }
+  auto cache = std::make_shared<DistanceCache>(P.getG(), P.getMaxTimestep());
+  cache->complete(P.getConfigGoal());
+
+  std::vector<Plan> plans(instances.size());
+  ThreadPool pool(4);
+  pool.parallelFor(instances.size(), [&](int k) {
+    PIBT solver(instances[k].get());
+    solver.setDistanceCache(cache);
+    solver.setMoveTable(k % 2 == 1);
+    solver.solve();
+    plans[k] = solver.getSolution();
+  });
+
+  auto solver = std::make_unique<PIBT>(&P);
+  solver->solve();
+  auto plan = solver->getSolution();
+  for (auto& plan_k : plans) {
+    ASSERT_EQ(plan_k.getMakespan(), plan.getMakespan());
+    for (int t = 0; t <= plan.getMakespan(); ++t) {
+      for (int i = 0; i < P.getNum(); ++i) {
+        ASSERT_EQ(plan_k.get(t, i), plan.get(t, i));
+      }
+    }
+  }
+}
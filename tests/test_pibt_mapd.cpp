@@ -1,4 +1,8 @@
+#include <filesystem>
+#include <fstream>
 #include <pibt_mapd.hpp>
+#include <regex>
+#include <sstream>
 
 #include "gtest/gtest.h"
 
@@ -11,3 +15,66 @@ TEST(PIBT_MAPD, solve)
   ASSERT_TRUE(solver->succeed());
   ASSERT_TRUE(solver->getSolution().validate(&P));
 }
+
+TEST(PIBT_MAPD, iterative_inheritance)
+{
+  // the same solution as the recursive version, same seed
+  // graphs differ, compare node ids
+  auto P1 = MAPD_Instance("../tests/instances/dense_mapd.txt");
+  auto P2 = MAPD_Instance("../tests/instances/dense_mapd.txt");
+  auto solver1 = std::make_unique<PIBT_MAPD>(&P1);
+  auto solver2 = std::make_unique<PIBT_MAPD>(&P2);
+  solver1->setRecursiveInheritance(true);
+  solver1->solve();
+  solver2->solve();
+
+  auto plan1 = solver1->getSolution();
+  auto plan2 = solver2->getSolution();
+  ASSERT_EQ(plan1.getMakespan(), plan2.getMakespan());
+  for (int t = 0; t <= plan1.getMakespan(); ++t) {
+    for (int i = 0; i < P1.getNum(); ++i) {
+      ASSERT_EQ(plan1.get(t, i)->id, plan2.get(t, i)->id);
+    }
+  }
+}
+
+TEST(PIBT_MAPD, stream)
+{
+  // the same log as keeping the whole plan in memory
+  auto read = [](const std::string& filename) {
+    std::ifstream file(filename);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+  };
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto log1 = (dir / "test_pibt_mapd_stream1.txt").string();
+  const auto log2 = (dir / "test_pibt_mapd_stream2.txt").string();
+  const auto spool = (dir / "test_pibt_mapd_stream.tmp").string();
+
+  auto P1 = MAPD_Instance("../tests/instances/dense_mapd.txt");
+  auto solver1 = std::make_unique<PIBT_MAPD>(&P1);
+  solver1->solve();
+  solver1->makeLog(log1);
+
+  auto P2 = MAPD_Instance("../tests/instances/dense_mapd.txt");
+  auto solver2 = std::make_unique<PIBT_MAPD>(&P2);
+  solver2->setPlanStream(spool, 7);
+  solver2->solve();
+  ASSERT_EQ(solver2->getSolution().getOffset(),
+            solver2->getSolution().getMakespan());
+  solver2->makeLog(log2);
+
+  // comp_time and timers (PIBT2_STATS) may differ,
+  // task ids are counted over instances
+  auto strip = [](std::string s) {
+    const auto pos = s.find("comp_time=");
+    s = s.substr(0, pos) + s.substr(s.find("preprocessing_comp_time"));
+    s = std::regex_replace(s, std::regex(R"(stats_\w+_ns=\d+\n)"), "");
+    s = std::regex_replace(s, std::regex(R"(\n\d+:)"), "\n:");
+    return std::regex_replace(s, std::regex(R"(\):-?\d+,)"), "):,");
+  };
+  ASSERT_EQ(strip(read(log1)), strip(read(log2)));
+  std::filesystem::remove(log1);
+  std::filesystem::remove(log2);
+}
@@ -71,6 +71,32 @@ TEST(Plan, add)
   ASSERT_EQ(plan1.getMakespan(), 2);
 }
 
+TEST(Plan, drop)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+
+  Plan plan;
+  plan.add({v, u});
+  plan.add({v, w});
+  plan.add({u, w});
+
+  plan.drop(2);
+  ASSERT_EQ(plan.getOffset(), 2);
+  ASSERT_EQ(plan.size(), 3);
+  ASSERT_EQ(plan.getMakespan(), 2);
+  ASSERT_EQ(plan.get(2, 0), u);
+
+  // the last configuration is always kept
+  plan.add({w, v});
+  plan.drop(10);
+  ASSERT_EQ(plan.getOffset(), 3);
+  ASSERT_EQ(plan.last(0), w);
+  ASSERT_FALSE(plan.validate({v, u}));
+}
+
 TEST(Plan, validate)
 {
   Grid G("8x8.map");
@@ -114,6 +140,52 @@ TEST(Plan, validate)
   plan5.add({v});
   plan5.add({w});
   ASSERT_FALSE(plan5.validate({v}, {w}));
+
+  // diagnostics
+  auto c3 = plan3.findConflict({v, u});
+  ASSERT_EQ(c3.kind, Plan::Conflict::VERTEX);
+  ASSERT_EQ(c3.t, 1);
+  ASSERT_EQ(c3.i, 1);
+  ASSERT_EQ(c3.j, 0);
+  ASSERT_EQ(c3.v, u);
+  ASSERT_EQ(plan4.findConflict({v, u}).kind, Plan::Conflict::SWAP);
+  ASSERT_EQ(plan5.findConflict({v}).kind, Plan::Conflict::MOVE);
+  ASSERT_EQ(plan2.findConflict({v, u}, {u, w}).kind, Plan::Conflict::GOAL);
+  ASSERT_EQ(plan1.findConflict({v, u}).kind, Plan::Conflict::START);
+  ASSERT_EQ(Plan().findConflict({v}).kind, Plan::Conflict::EMPTY);
+}
+
+TEST(Plan, findConflictParallel)
+{
+  Grid G("8x8.map");
+  Node* a = G.getNode(0);
+  Node* b = G.getNode(1);
+  Node* c = G.getNode(8);
+  Node* d = G.getNode(9);
+
+  // agent-0: a <-> b, agent-1: d <-> c, conflicts at t=77 (b) and t=90 (a)
+  auto make = [&](const bool compact) {
+    Plan plan;
+    plan.setCompact(compact);
+    for (int t = 0; t <= 100; ++t) {
+      Node* v = (t % 2 == 0) ? a : b;
+      Node* u = (t % 2 == 0) ? d : c;
+      if (t == 77) u = b;
+      if (t == 90) u = a;
+      plan.add({v, u});
+    }
+    return plan;
+  };
+  for (auto compact : {false, true}) {
+    const Plan plan = make(compact);
+    for (auto num_threads : {1, 4}) {
+      auto conflict = plan.findConflict({a, d}, {}, num_threads);
+      ASSERT_EQ(conflict.kind, Plan::Conflict::VERTEX);
+      ASSERT_EQ(conflict.t, 77);
+      ASSERT_EQ(conflict.v, b);
+      ASSERT_FALSE(plan.validate({a, d}, num_threads));
+    }
+  }
 }
 
 TEST(Plan, maxConstraintTime)
@@ -130,3 +202,60 @@ TEST(Plan, maxConstraintTime)
   ASSERT_EQ(plan.getMaxConstraintTime(0, v, u, &G), 1);
   ASSERT_EQ(plan.getMaxConstraintTime(1, u, w, &G), 0);
 }
+
+TEST(Plan, compact)
+{
+  Grid G("8x8.map");
+  std::mt19937 MT(0);
+  const int num_agents = 5;
+  const int makespan = 500;
+
+  // random walks, with a jump at t=300
+  Plan plan1;
+  Plan plan2;
+  plan2.setCompact(true);
+  ASSERT_TRUE(plan2.isCompact());
+  Config c;
+  for (int i = 0; i < num_agents; ++i) c.push_back(G.getNode(i));
+  for (int t = 0; t <= makespan; ++t) {
+    if (t > 0) {
+      for (int i = 0; i < num_agents; ++i) {
+        Nodes C = c[i]->neighbor;
+        C.push_back(c[i]);
+        c[i] = (t == 300) ? G.getNode(63 - i) : randomChoose(C, &MT);
+      }
+    }
+    plan1.add(c);
+    plan2.add(c);
+  }
+  ASSERT_EQ(plan2.size(), makespan + 1);
+  ASSERT_EQ(plan2.getSOC(), plan1.getSOC());
+  ASSERT_TRUE(sameConfig(plan2.last(), plan1.last()));
+
+  // sequential and random access
+  for (int t = 0; t <= makespan; ++t) {
+    ASSERT_TRUE(sameConfig(plan2.get(t), plan1.get(t)));
+  }
+  for (int k = 0; k < 1000; ++k) {
+    const int t = getRandomInt(0, makespan, &MT);
+    const int i = getRandomInt(0, num_agents - 1, &MT);
+    ASSERT_EQ(plan2.get(t, i), plan1.get(t, i));
+  }
+  for (int i = 0; i < num_agents; ++i) {
+    ASSERT_EQ(plan2.getPath(i), plan1.getPath(i));
+    ASSERT_EQ(plan2.getPathCost(i), plan1.getPathCost(i));
+  }
+
+  // join, the representation is kept
+  Plan plan3;
+  plan3.setCompact(true);
+  plan3 += plan1;
+  ASSERT_TRUE(plan3.isCompact());
+  ASSERT_EQ(plan3.getSOC(), plan1.getSOC());
+
+  // dropped by blocks
+  plan2.drop(400);
+  ASSERT_LE(plan2.getOffset(), 400);
+  ASSERT_GT(plan2.getOffset(), 0);
+  ASSERT_TRUE(sameConfig(plan2.get(400), plan1.get(400)));
+}
@@ -0,0 +1,15 @@
+#include <priority_order.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(PriorityOrder, basic)
+{
+  PriorityOrder order;
+  order.init({2, 0, 3, 1});
+  ASSERT_EQ(order.get(), std::vector<int>({2, 0, 3, 1}));
+
+  // agent-id -> key
+  ASSERT_EQ(order.update({1, 0, 1, 3}), std::vector<int>({3, 2, 0, 1}));
+  ASSERT_EQ(order.update({0, 0, 0, 0}), std::vector<int>({2, 0, 3, 1}));
+  ASSERT_EQ(order.update({5, 2, 0, 5}), std::vector<int>({0, 3, 1, 2}));
+}
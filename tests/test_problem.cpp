@@ -63,3 +63,71 @@ TEST(MAPD_Instance, load)
     ASSERT_TRUE(int(P.getOpenTasks().size()) <= P.getTaskNum());
   }
 }
+
+TEST(MAPF_Instance, irregular_lines)
+{
+  // CRLF, comments, malformed lines are ignored
+  auto P = MAPF_Instance("../tests/instances/irregular.txt");
+  Graph* G = P.getG();
+
+  ASSERT_EQ(P.getNum(), 3);
+  ASSERT_EQ(P.getMaxTimestep(), 12);
+  ASSERT_EQ(P.getMaxCompTime(), 2000);
+  Config starts = P.getConfigStart();
+  Config goals = P.getConfigGoal();
+  ASSERT_EQ(starts[0], G->getNode(0, 0));
+  ASSERT_EQ(goals[0], G->getNode(1, 0));
+  ASSERT_EQ(starts[1], G->getNode(2, 2));
+  ASSERT_EQ(goals[1], G->getNode(3, 3));
+  ASSERT_EQ(starts[2], G->getNode(4, 4));
+  ASSERT_EQ(goals[2], G->getNode(5, 5));
+}
+
+TEST(MAPD_Instance, special_nodes)
+{
+  // warehouse.map.pd
+  auto P = MAPD_Instance("../tests/instances/dense_mapd.txt");
+  ASSERT_EQ(P.getNum(), 50);
+  ASSERT_EQ(P.getPickupLocs().size(), 302);
+  ASSERT_EQ(P.getDeliveryLocs().size(), 302);
+  ASSERT_EQ(P.getEndpoints().size(), 352);
+}
+
+TEST(MAPF_Instance, map_loader)
+{
+  // one graph shared by instances
+  Grid G("8x8.map");
+  int num_loaded = 0;
+  auto load_map = [&](const std::string&) -> Graph* {
+    ++num_loaded;
+    return &G;
+  };
+  {
+    auto P1 = MAPF_Instance("../tests/instances/toy_problem.txt", load_map);
+    auto P2 = MAPF_Instance("../tests/instances/toy_problem.txt", load_map, 3);
+    ASSERT_EQ(num_loaded, 2);
+    ASSERT_EQ(P1.getG(), &G);
+    ASSERT_EQ(P1.getStart(1), G.getNode(1, 1));
+    // seed is overridden
+    std::mt19937 MT(3);
+    ASSERT_EQ((*P2.getMT())(), MT());
+  }
+  // not deleted by instances
+  ASSERT_EQ(G.getNode(0, 0)->id, 0);
+}
+
+TEST(MAPF_Instance, no_seed)
+{
+  // the default seed is used for random starts and goals
+  auto P1 = MAPF_Instance("../tests/instances/no_seed.txt");
+  Grid G("8x8.map");
+  auto load_map = [&](const std::string&) -> Graph* { return &G; };
+  auto P2 =
+      MAPF_Instance("../tests/instances/no_seed.txt", load_map, DEFAULT_SEED);
+  ASSERT_NE(P1.getMT(), nullptr);
+  ASSERT_EQ(P1.getNum(), 10);
+  for (int i = 0; i < P1.getNum(); ++i) {
+    ASSERT_EQ(P1.getStart(i)->id, P2.getStart(i)->id);
+    ASSERT_EQ(P1.getGoal(i)->id, P2.getGoal(i)->id);
+  }
+}
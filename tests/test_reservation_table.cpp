@@ -0,0 +1,51 @@
+#include <reservation_table.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(ReservationTable, basic)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+
+  ReservationTable table(G.getNodesSize());
+  table.insert(0, {v, u, w});
+  table.reserve(3, w, 1);
+  ASSERT_TRUE(table.isReserved(1, u));
+  ASSERT_FALSE(table.isReserved(1, v));
+  ASSERT_EQ(table.getAgent(2, w), 0);
+  ASSERT_EQ(table.getAgent(3, w), 1);
+  ASSERT_EQ(table.getAgent(5, w), ReservationTable::NIL);
+  ASSERT_EQ(table.getHorizon(), 4);
+
+  // incremental removal
+  table.remove({v, u, w});
+  ASSERT_FALSE(table.isReserved(1, u));
+  ASSERT_EQ(table.getAgent(3, w), 1);
+  table.release(3, w);
+  ASSERT_FALSE(table.isReserved(3, w));
+}
+
+TEST(ReservationTable, park)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+
+  ReservationTable table(G.getNodesSize());
+  table.insert(2, {v, u}, 1, true);
+  ASSERT_FALSE(table.isReserved(0, v));
+  ASSERT_EQ(table.getAgent(1, v), 2);
+  ASSERT_FALSE(table.isReserved(1, u));
+  ASSERT_EQ(table.getAgent(2, u), 2);
+  ASSERT_EQ(table.getAgent(100, u), 2);
+
+  table.remove({v, u}, 1, true);
+  ASSERT_FALSE(table.isReserved(100, u));
+  ASSERT_FALSE(table.isReserved(1, v));
+
+  table.insert(0, {u}, 0, true);
+  table.clear();
+  ASSERT_FALSE(table.isReserved(0, u));
+}
@@ -0,0 +1,97 @@
+#include <search_utils.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(Arena, create)
+{
+  struct Item {
+    int a;
+    Item* p;
+    Item(int _a, Item* _p) : a(_a), p(_p) {}
+  };
+  Arena<Item> arena;
+  Item* root = arena.create(0, nullptr);
+  Item* item = root;
+  for (int i = 1; i < 10000; ++i) item = arena.create(i, item);
+  for (int i = 9999; i >= 0; --i) {
+    ASSERT_EQ(item->a, i);
+    item = item->p;
+  }
+  ASSERT_EQ(item, nullptr);
+
+  // memory is reused
+  arena.clear();
+  ASSERT_EQ(arena.create(0, nullptr), root);
+}
+
+TEST(KeySet, basic)
+{
+  KeySet set(4);
+  for (uint64_t key = 0; key < 1000; ++key) {
+    ASSERT_TRUE(set.insert(key << 32 | key));
+  }
+  ASSERT_EQ(set.size(), 1000);
+  ASSERT_FALSE(set.insert(3ULL << 32 | 3));
+  ASSERT_TRUE(set.contains(5ULL << 32 | 5));
+  ASSERT_FALSE(set.contains(5ULL << 32 | 6));
+
+  set.clear();
+  ASSERT_EQ(set.size(), 0);
+  ASSERT_FALSE(set.contains(5ULL << 32 | 5));
+
+  // reused after clear
+  ASSERT_TRUE(set.insert(5ULL << 32 | 5));
+  ASSERT_FALSE(set.insert(5ULL << 32 | 5));
+  ASSERT_EQ(set.size(), 1);
+}
+
+TEST(BucketQueue, basic)
+{
+  BucketQueue<int> Q;
+  Q.push(0, 3, 1);
+  Q.push(1, 1, 5);
+  Q.push(2, 3, 0);
+  Q.push(3, 1, 2);
+  Q.push(4, 1, 2);
+  ASSERT_EQ(Q.size(), 5);
+  ASSERT_EQ(Q.pop(), 4);  // LIFO for exact ties
+  ASSERT_EQ(Q.pop(), 3);
+  ASSERT_EQ(Q.pop(), 1);
+
+  // lower keys than popped ones
+  Q.push(5, 0, 7);
+  ASSERT_EQ(Q.pop(), 5);
+  ASSERT_EQ(Q.pop(), 2);
+  ASSERT_EQ(Q.pop(), 0);
+  ASSERT_TRUE(Q.empty());
+
+  Q.push(6, 2, 2);
+  Q.clear();
+  ASSERT_TRUE(Q.empty());
+  Q.push(7, 4, 4);
+  ASSERT_EQ(Q.pop(), 7);
+}
+
+TEST(KeyMap, basic)
+{
+  KeyMap map(4);
+  for (uint64_t key = 0; key < 1000; ++key) map.set(key << 32 | key, key);
+  ASSERT_EQ(map.size(), 1000);
+  ASSERT_EQ(map.get(3ULL << 32 | 3, -1), 3);
+  ASSERT_EQ(map.get(3ULL << 32 | 4, -1), -1);
+  map.set(3ULL << 32 | 3, 10);
+  ASSERT_EQ(map.size(), 1000);
+  ASSERT_EQ(map.get(3ULL << 32 | 3, -1), 10);
+  map.set(3ULL << 32 | 3, 3);
+
+  // erase, remaining keys are still reachable
+  for (uint64_t key = 0; key < 1000; key += 2) map.erase(key << 32 | key);
+  ASSERT_EQ(map.size(), 500);
+  for (uint64_t key = 0; key < 1000; ++key) {
+    ASSERT_EQ(map.get(key << 32 | key, -1), (key % 2 == 0) ? -1 : (int)key);
+  }
+
+  map.clear();
+  ASSERT_EQ(map.size(), 0);
+  ASSERT_EQ(map.get(5ULL << 32 | 5, -1), -1);
+}
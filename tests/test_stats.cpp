@@ -0,0 +1,69 @@
+#include <hca.hpp>
+#include <pibt.hpp>
+#include <sstream>
+#include <stats.hpp>
+#include <tp.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(Stats, basic)
+{
+  Stats a, b;
+  a.count(Stats::BACKTRACKS, 2);
+  a.countMax(Stats::MAX_INHERITANCE_DEPTH, 3);
+  b.count(Stats::BACKTRACKS);
+  b.countMax(Stats::MAX_INHERITANCE_DEPTH, 1);
+  {
+    auto timer = b.timer(Stats::PLANNING);
+  }
+  a.merge(b);
+
+  const uint64_t on = Stats::ENABLED ? 1 : 0;
+  ASSERT_EQ(a.getCount(Stats::BACKTRACKS), 3 * on);
+  ASSERT_EQ(a.getCount(Stats::MAX_INHERITANCE_DEPTH), 3 * on);
+  ASSERT_EQ(a.getTime(Stats::PLANNING), b.getTime(Stats::PLANNING));
+  ASSERT_EQ(a.getTime(Stats::ACTING), 0);
+
+  std::stringstream log;
+  a.writeLog(log);
+  ASSERT_NE(log.str().find("stats_backtracks=" + std::to_string(3 * on)),
+            std::string::npos);
+  std::stringstream json;
+  a.writeJSON(json);
+  ASSERT_EQ(json.str().front(), '{');
+  ASSERT_NE(json.str().find("\"planning\": "), std::string::npos);
+}
+
+TEST(Stats, solvers)
+{
+  auto P = MAPF_Instance("../tests/instances/example.txt");
+  PIBT pibt(&P);
+  pibt.solve();
+  HCA hca(&P);
+  hca.solve();
+  auto Q = MAPD_Instance("../tests/instances/tp_mapd.txt");
+  TP tp(&Q);
+  tp.solve();
+  if (!Stats::ENABLED) {
+    ASSERT_EQ(pibt.getStats().getTime(Stats::PLANNING), 0);
+    return;
+  }
+
+  // the results are the same as without instrumentation
+  ASSERT_TRUE(pibt.succeed());
+  ASSERT_GT(pibt.getStats().getTime(Stats::DISTANCE_TABLE), 0);
+  ASSERT_GT(pibt.getStats().getTime(Stats::PLANNING), 0);
+  ASSERT_GT(pibt.getStats().getTime(Stats::ACTING), 0);
+  ASSERT_LE(pibt.getStats().getCount(Stats::MAX_INHERITANCE_DEPTH),
+            pibt.getStats().getCount(Stats::INHERITANCES));
+
+  ASSERT_TRUE(hca.succeed());
+  ASSERT_GE(hca.getStats().getCount(Stats::ASTAR_GENERATED),
+            hca.getStats().getCount(Stats::ASTAR_EXPANDED));
+  ASSERT_GT(hca.getStats().getCount(Stats::ASTAR_EXPANDED), 0);
+  ASSERT_GT(hca.getStats().getCount(Stats::RESERVATIONS), 0);
+
+  ASSERT_TRUE(tp.succeed());
+  ASSERT_GT(tp.getStats().getTime(Stats::ASSIGNMENT), 0);
+  ASSERT_GT(tp.getStats().getCount(Stats::RESERVATIONS), 0);
+}
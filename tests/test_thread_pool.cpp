@@ -0,0 +1,24 @@
+#include <thread_pool.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(ThreadPool, parallelFor)
+{
+  for (int num_threads : {1, 4}) {
+    ThreadPool pool(num_threads);
+    std::vector<int> arr(100, 0);
+    pool.parallelFor(arr.size(), [&](int i) { arr[i] = i * i; });
+    for (int i = 0; i < (int)arr.size(); ++i) ASSERT_EQ(arr[i], i * i);
+  }
+}
+
+TEST(ThreadPool, submit)
+{
+  ThreadPool pool(2);
+  std::vector<int> arr(2, 0);
+  pool.submit([&] { arr[0] = 1; });
+  pool.submit([&] { arr[1] = 2; });
+  pool.wait();
+  ASSERT_EQ(arr[0], 1);
+  ASSERT_EQ(arr[1], 2);
+}